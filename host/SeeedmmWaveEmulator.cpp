@@ -0,0 +1,478 @@
+#include "SeeedmmWaveEmulator.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "SEEED_MR60BHA2.h"
+#include "esp_timer.h"
+
+// The library's own framing, so that the emulator speaks exactly the
+// protocol the parser is written against
+class EmulatorFrames : public SeeedmmWave {
+ public:
+  using SeeedmmWave::packetFrame;
+  using SeeedmmWave::calculateChecksum;
+  using SeeedmmWave::validateChecksum;
+
+ protected:
+  bool handleType(uint16_t _type, const uint8_t* data,
+                  size_t data_len) override {
+    (void)_type;
+    (void)data;
+    (void)data_len;
+    return false;
+  }
+};
+
+static EmulatorFrames& frames() {
+  static EmulatorFrames* codec = new EmulatorFrames();
+  return *codec;
+}
+
+static const float kTwoPi = 6.2831853f;
+
+// Room the people walk in, in metres from the radar
+static const float kRoomHalfWidth = 2.0f;
+static const float kRoomNear      = 0.3f;
+static const float kRoomFar       = 5.0f;
+
+// Settings of a radar after 0x2110, see SEEED_MR60FDA2::resetSetting()
+static const FallRadarProfile kDefaultProfile = {2.2f, 0.5f, 3,   0.5f,
+                                                 0.5f, 0.5f, 0.5f};
+
+template <typename T>
+static constexpr uint16_t typeId(T type) {
+  return static_cast<uint16_t>(type);
+}
+
+SeeedmmWaveEmulator::SeeedmmWaveEmulator(const MMWaveEmulatorConfig& config)
+    : _config(config) {
+  if (_config.rate_scale <= 0)
+    _config.rate_scale = 1;
+  reset();
+}
+
+void SeeedmmWaveEmulator::reset() {
+  _stats = MMWaveEmulatorStats();
+  _random.seed(_config.seed);
+  _responses.clear();
+  _request.clear();
+  _profile         = kDefaultProfile;
+  _now_us          = 0;
+  _scene_us        = 0;
+  _next_id         = 0;
+  _present         = true;
+  _motion_until_us = 0;
+  _fall_until_us   = 0;
+  _distance        = 0.8f;
+
+  // Approximate report periods of the sensor firmware
+  if (_config.device == MMWaveEmulatedDevice::MR60BHA2) {
+    _streams = {
+        {typeId(TypeHeartBreath::TypeHeartBreathPhase), 100000, 0},
+        {typeId(TypeHeartBreath::TypeBreathRate), 1000000, 0},
+        {typeId(TypeHeartBreath::TypeHeartRate), 1000000, 0},
+        {typeId(TypeHeartBreath::TypeHeartBreathDistance), 1000000, 0},
+        {typeId(TypeHeartBreath::ReportHumanDetection), 1000000, 0},
+        {typeId(TypeHeartBreath::Report3DPointCloudTargetInfo), 200000, 0},
+        {typeId(TypeHeartBreath::Report3DPointCloudDetection), 200000, 0},
+    };
+  } else {
+    _streams = {
+        {typeId(TypeFallDetection::ReportUnmannedDetection), 1000000, 0},
+        {typeId(TypeFallDetection::ReportFallDetection), 1000000, 0},
+        {typeId(TypeFallDetection::Report3DPointCloudTargetInfo), 200000, 0},
+        {typeId(TypeFallDetection::Report3DPointCloudDetection), 200000, 0},
+    };
+  }
+  // Spread the first reports so that the streams do not stay in lockstep
+  for (size_t i = 0; i < _streams.size(); i++) {
+    _streams[i].due_us = int64_t(i + 1) * 1000;
+  }
+
+  _people.clear();
+  uint32_t people = _config.max_people ? 1 : 0;
+  for (uint32_t i = 0; i < people; i++) {
+    _people.push_back({uniform(-1, 1), uniform(0.5f, 3), 0, 0});
+  }
+}
+
+int64_t SeeedmmWaveEmulator::nextDue() const {
+  int64_t due = INT64_MAX;
+  for (const Stream& stream : _streams) {
+    due = std::min(due, stream.due_us);
+  }
+  if (!_responses.empty())
+    due = std::min(due, _responses.front().due_us);
+  return due;
+}
+
+size_t SeeedmmWaveEmulator::generate(int64_t until_us,
+                                     std::vector<uint8_t>& out,
+                                     std::vector<int64_t>* times) {
+  size_t count = 0;
+  for (;;) {
+    int64_t due = nextDue();
+    if (due > until_us)
+      break;
+    size_t start = out.size();
+    if (!_responses.empty() && _responses.front().due_us == due) {
+      const Response& response = _responses.front();
+      frame(response.type, response.id, response.payload.data(),
+            response.payload.size(), out);
+      _stats.responses++;
+      _responses.pop_front();
+    } else {
+      Stream* next = &_streams[0];
+      for (Stream& stream : _streams) {
+        if (stream.due_us < next->due_us)
+          next = &stream;
+      }
+      advanceScene(due);
+      report(next->type, due, out);
+      int64_t period = int64_t(next->period_us / _config.rate_scale);
+      next->due_us += period > 0 ? period : 1;
+    }
+    if (times)
+      times->insert(times->end(), out.size() - start, due);
+    count++;
+  }
+  if (until_us > _now_us)
+    _now_us = until_us;
+  return count;
+}
+
+/**
+ * @brief Move the scene on to a time: people walking, entering and leaving,
+ * presence changes, motion and falls.
+ */
+void SeeedmmWaveEmulator::advanceScene(int64_t time_us) {
+  float dt  = (time_us - _scene_us) / 1e6f;
+  _scene_us = time_us;
+  if (dt <= 0)
+    return;
+
+  if (_config.presence_period_s > 0 &&
+      chance(1 / _config.presence_period_s, dt)) {
+    _present = !_present;
+    _stats.presence_changes++;
+    _people.clear();
+    if (_present && _config.max_people)
+      _people.push_back({uniform(-1, 1), uniform(0.5f, 3), 0, 0});
+  }
+  if (!_present)
+    return;
+
+  // About one person entering or leaving a minute
+  if (chance(1 / 60.0f, dt)) {
+    if (_people.size() < _config.max_people && uniform(0, 1) < 0.5f)
+      _people.push_back({kRoomHalfWidth, uniform(1, 4), -0.5f, 0});
+    else if (_people.size() > 1)
+      _people.pop_back();
+  }
+  for (Person& person : _people) {
+    person.vx += gaussian(0.3f) * dt;
+    person.vy += gaussian(0.3f) * dt;
+    person.vx = std::max(-1.0f, std::min(1.0f, person.vx));
+    person.vy = std::max(-1.0f, std::min(1.0f, person.vy));
+    person.x += person.vx * dt;
+    person.y += person.vy * dt;
+    if (fabsf(person.x) > kRoomHalfWidth) {
+      person.x  = copysignf(kRoomHalfWidth, person.x);
+      person.vx = -person.vx;
+    }
+    if (person.y < kRoomNear || person.y > kRoomFar) {
+      person.y  = person.y < kRoomNear ? kRoomNear : kRoomFar;
+      person.vy = -person.vy;
+    }
+  }
+
+  if (time_us >= _motion_until_us &&
+      chance(_config.motion_per_min / 60, dt)) {
+    _motion_until_us = time_us + int64_t(uniform(1, 4) * 1e6f);
+    _stats.motions++;
+  }
+  if (_config.device == MMWaveEmulatedDevice::MR60FDA2 &&
+      time_us >= _fall_until_us &&
+      chance(_config.falls_per_hour / 3600, dt)) {
+    _fall_until_us = time_us + 5000000;
+    _stats.falls++;
+  }
+  _distance += gaussian(0.05f) * dt;
+  _distance = std::max(0.4f, std::min(1.5f, _distance));
+}
+
+size_t SeeedmmWaveEmulator::report(uint16_t type, int64_t time_us,
+                                   std::vector<uint8_t>& out) {
+  float t     = time_us / 1e6f;
+  bool moving = time_us < _motion_until_us;
+  uint8_t payload[MMWAVE_MAX_PAYLOAD];
+  size_t len;
+
+  switch (type) {
+    case typeId(TypeHeartBreath::TypeHeartBreathPhase): {
+      float breath = 0, heart = 0, total = 0;
+      if (_present) {
+        breath = 0.8f * sinf(kTwoPi * _config.breath_rate / 60 * t);
+        heart  = 0.08f * sinf(kTwoPi * _config.heart_rate / 60 * t);
+        // Body movement swamps both components
+        if (moving)
+          total = uniform(-3, 3);
+      }
+      breath += gaussian(_config.phase_noise);
+      heart += gaussian(_config.phase_noise);
+      total += breath + heart + gaussian(_config.phase_noise);
+      len = HeartBreathPayload::encode(payload, total, breath, heart);
+      break;
+    }
+    case typeId(TypeHeartBreath::TypeBreathRate):
+    case typeId(TypeHeartBreath::TypeHeartRate): {
+      bool heart_rate = type == typeId(TypeHeartBreath::TypeHeartRate);
+      float rate      = 0;
+      if (_present) {
+        rate = heart_rate ? _config.heart_rate : _config.breath_rate;
+        rate += gaussian(moving ? rate * 0.2f : rate * 0.02f);
+        rate = std::max(0.0f, rate);
+      }
+      len = MMWaveFloatPayload::encode(payload, rate);
+      break;
+    }
+    case typeId(TypeHeartBreath::TypeHeartBreathDistance):
+      len = RangePayload::encode(payload, uint32_t(_present),
+                                 _present ? _distance : 0.0f);
+      break;
+    case typeId(TypeHeartBreath::ReportHumanDetection):
+      // Same type as ReportUnmannedDetection on the MR60FDA2
+      len = MMWaveFlagPayload::encode(payload, uint8_t(_present));
+      break;
+    case typeId(TypeFallDetection::ReportFallDetection):
+      len = MMWaveFlagPayload::encode(payload,
+                                      uint8_t(time_us < _fall_until_us));
+      break;
+    case typeId(TypeHeartBreath::Report3DPointCloudTargetInfo):
+    case typeId(TypeHeartBreath::Report3DPointCloudDetection): {
+      bool targets =
+          type == typeId(TypeHeartBreath::Report3DPointCloudTargetInfo);
+      // Point clouds can be longer than MMWAVE_MAX_PAYLOAD
+      uint32_t points = _present ? uint32_t(_people.size()) : 0;
+      if (!targets)
+        points *= _config.cloud_points;
+      std::vector<uint8_t> cloud(sizeof(uint32_t) +
+                                 points * MMWAVE_POINT_SIZE);
+      len = pointCloud(cloud.data(), targets);
+      return frame(type, _next_id++, cloud.data(), len, out);
+    }
+    default:
+      return 0;
+  }
+  return frame(type, _next_id++, payload, len, out);
+}
+
+/**
+ * @brief Encode the people as target info, one point each, or as a point
+ * cloud of cloud_points points around each.
+ */
+size_t SeeedmmWaveEmulator::pointCloud(uint8_t* payload, bool targets) {
+  uint32_t per_person = targets ? 1 : _config.cloud_points;
+  uint32_t count      = _present ? uint32_t(_people.size()) * per_person : 0;
+  MMWaveWire<uint32_t>::encode(count, payload);
+  uint8_t* point = payload + sizeof(uint32_t);
+  for (uint32_t i = 0; i < count; i++, point += MMWAVE_POINT_SIZE) {
+    const Person& person = _people[i / per_person];
+    float spread         = targets ? 0.0f : 0.15f;
+    MMWaveWire<float>::encode(person.x + gaussian(spread), point);
+    MMWaveWire<float>::encode(person.y + gaussian(spread), point + 4);
+    // Doppler bins of 0.1 m/s towards the radar
+    MMWaveWire<int32_t>::encode(int32_t(lroundf(-person.vy * 10)),
+                                point + 8);
+    MMWaveWire<int32_t>::encode(int32_t(i / per_person), point + 12);
+  }
+  return point - payload;
+}
+
+size_t SeeedmmWaveEmulator::frame(uint16_t type, uint16_t id,
+                                  const uint8_t* payload, size_t len,
+                                  std::vector<uint8_t>& out) {
+  size_t start = out.size();
+  out.resize(start + SIZE_FRAME_HEADER + len + SIZE_DATA_CKSUM);
+  // packetFrame() leaves the data checksum out without a payload pointer
+  static const uint8_t kEmpty = 0;
+  size_t size = frames().packetFrame(type, id, payload ? payload : &kEmpty,
+                                     len, &out[start]);
+  out.resize(start + size);
+  _stats.bytes += size;
+  _stats.frames++;
+  return size;
+}
+
+void SeeedmmWaveEmulator::receive(const uint8_t* data, size_t len,
+                                  int64_t time_us) {
+  _request.insert(_request.end(), data, data + len);
+  for (;;) {
+    size_t sof = 0;
+    while (sof < _request.size() && _request[sof] != SOF_BYTE) {
+      sof++;
+    }
+    _request.erase(_request.begin(), _request.begin() + sof);
+    if (_request.size() < SIZE_FRAME_HEADER)
+      return;
+    if (!frames().validateChecksum(_request.data(),
+                                   SIZE_FRAME_HEADER - SIZE_HEAD_CKSUM,
+                                   _request[SIZE_FRAME_HEADER - 1])) {
+      _request.erase(_request.begin());
+      continue;
+    }
+
+    uint16_t id       = (_request[1] << 8) | _request[2];
+    uint16_t data_len = (_request[3] << 8) | _request[4];
+    uint16_t type     = (_request[5] << 8) | _request[6];
+    size_t frame_len  = SIZE_FRAME_HEADER;
+    if (data_len) {
+      frame_len += data_len + SIZE_DATA_CKSUM;
+      if (_request.size() < frame_len)
+        return;
+      if (!frames().validateChecksum(&_request[SIZE_FRAME_HEADER], data_len,
+                                     _request[frame_len - 1])) {
+        _request.erase(_request.begin());
+        continue;
+      }
+    } else if (_request.size() > frame_len &&
+               _request[frame_len] == frames().calculateChecksum(nullptr,
+                                                                 0)) {
+      // The checksum of an empty payload, when the sender includes it
+      frame_len++;
+    }
+    _stats.requests++;
+    handleRequest(type, id, &_request[SIZE_FRAME_HEADER], data_len, time_us);
+    _request.erase(_request.begin(), _request.begin() + frame_len);
+  }
+}
+
+void SeeedmmWaveEmulator::handleRequest(uint16_t type, uint16_t id,
+                                        const uint8_t* payload, size_t len,
+                                        int64_t time_us) {
+  if (_config.device != MMWaveEmulatedDevice::MR60FDA2)
+    return;
+
+  Response response = {time_us + _config.response_delay_us, type, id, {}};
+  uint8_t flag      = 0;
+  switch (type) {
+    case typeId(TypeFallDetection::InstallationHeight): {
+      float height;
+      // Accepted between 1 m (excluded) and 5 m, see setInstallationHeight()
+      if (MMWaveFloatPayload::decode(payload, len, height) && height > 1 &&
+          height <= 5) {
+        _profile.height = height;
+        flag            = 1;
+      }
+      break;
+    }
+    case typeId(TypeFallDetection::FallThreshold):
+      flag = MMWaveFloatPayload::decode(payload, len, _profile.threshold);
+      break;
+    case typeId(TypeFallDetection::FallSensitivity):
+      flag = MMWaveU32Payload::decode(payload, len, _profile.sensitivity);
+      break;
+    case typeId(TypeFallDetection::AlarmParameters): {
+      FallAlarmArea area;
+      if (AlarmAreaPayload::decode(payload, len, area)) {
+        _profile.rect_XL = area.rect_XL;
+        _profile.rect_XR = area.rect_XR;
+        _profile.rect_ZF = area.rect_ZF;
+        _profile.rect_ZB = area.rect_ZB;
+        flag             = 1;
+      }
+      break;
+    }
+    case typeId(TypeFallDetection::RadarParameters):
+      response.payload.resize(RadarParametersPayload::kSize);
+      RadarParametersPayload::encode(
+          response.payload.data(), _profile.height, _profile.threshold,
+          _profile.sensitivity, _profile.rect_XL, _profile.rect_XR,
+          _profile.rect_ZF, _profile.rect_ZB);
+      break;
+    case typeId(TypeFallDetection::RadarInitSetting):
+      _profile = kDefaultProfile;
+      return;
+    default:
+      // Sent without waiting for an answer
+      return;
+  }
+  if (response.payload.empty()) {
+    response.payload.resize(MMWaveFlagPayload::kSize);
+    MMWaveFlagPayload::encode(response.payload.data(), flag);
+  }
+  // Keep the responses in time order behind those already pending
+  if (!_responses.empty() && _responses.back().due_us > response.due_us)
+    response.due_us = _responses.back().due_us;
+  _responses.push_back(std::move(response));
+}
+
+void SeeedmmWaveEmulatorTransport::rewind() {
+  _emulator.reset();
+  _fifo.clear();
+  _fifo_times.clear();
+  _started       = false;
+  _read_time_us  = 0;
+  _overrun       = 0;
+  _rx_high_water = 0;
+}
+
+/**
+ * @brief Move the frames that came due into the RX buffer.
+ */
+void SeeedmmWaveEmulatorTransport::fill() {
+  if (!_started) {
+    _started  = true;
+    _start_us = esp_timer_get_time();
+  }
+  int64_t until;
+  if (_paced)
+    until = esp_timer_get_time() - _start_us;
+  else if (_fifo.empty())
+    until = _emulator.nextDue();
+  else
+    return;
+  if (_duration_us > 0 && until > _duration_us)
+    until = _duration_us;
+  if (until <= _emulator.now() && !_fifo.empty())
+    return;
+
+  _generated.clear();
+  _generated_times.clear();
+  _emulator.generate(until, _generated, &_generated_times);
+  for (size_t i = 0; i < _generated.size(); i++) {
+    if (_fifo.size() >= _rx_capacity) {
+      _overrun += _generated.size() - i;
+      break;
+    }
+    _fifo.push_back(_generated[i]);
+    _fifo_times.push_back(_generated_times[i]);
+  }
+  _rx_high_water = std::max(_rx_high_water, _fifo.size());
+}
+
+size_t SeeedmmWaveEmulatorTransport::available() {
+  fill();
+  return _fifo.size();
+}
+
+size_t SeeedmmWaveEmulatorTransport::read(uint8_t* data, size_t len) {
+  len = std::min(len, available());
+  if (len == 0)
+    return 0;
+  std::copy(_fifo.begin(), _fifo.begin() + len, data);
+  _read_time_us = _fifo_times[len - 1];
+  _fifo.erase(_fifo.begin(), _fifo.begin() + len);
+  _fifo_times.erase(_fifo_times.begin(), _fifo_times.begin() + len);
+  return len;
+}
+
+size_t SeeedmmWaveEmulatorTransport::write(const uint8_t* data, size_t len) {
+  int64_t now = _paced && _started ? esp_timer_get_time() - _start_us
+                                   : _emulator.now();
+  _emulator.receive(data, len, now);
+  return len;
+}
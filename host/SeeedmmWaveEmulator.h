@@ -0,0 +1,263 @@
+/**
+ * @file SeeedmmWaveEmulator.h
+ *
+ * @note Software MR60BHA2 / MR60FDA2 producing the frames of a live sensor.
+ *
+ * SeeedmmWaveEmulator synthesises the report stream of either radar on a
+ * virtual clock, framed by the library's own packetFrame():
+ *
+ * - MR60BHA2: total, breath and heart phases following the configured rates
+ *   with noise and motion artefacts, breath and heart rate, distance,
+ *   presence, target info and point clouds of the people in the room.
+ * - MR60FDA2: presence, fall events, target info and point clouds, and the
+ *   acknowledgement or parameter response to every request written to it.
+ *
+ * Every report period is divided by rate_scale, so a stream many times
+ * denser than the real sensor's can be produced. Presence toggles, people
+ * entering and leaving, motion and falls are random events with the
+ * configured mean rates, drawn from a seeded generator: the same
+ * configuration always gives the same stream.
+ *
+ * SeeedmmWaveEmulatorTransport hands the stream to SeeedmmWave on a host,
+ * paced against the host clock like a UART, or as fast as it is read.
+ */
+
+#ifndef SEEEDMMWAVE_EMULATOR_H
+#define SEEEDMMWAVE_EMULATOR_H
+
+#include <stdint.h>
+
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "SEEED_MR60FDA2.h"
+#include "SeeedmmWaveTransport.h"
+
+enum class MMWaveEmulatedDevice : uint8_t {
+  MR60BHA2,
+  MR60FDA2,
+};
+
+typedef struct MMWaveEmulatorConfig {
+  MMWaveEmulatedDevice device = MMWaveEmulatedDevice::MR60BHA2;
+  float rate_scale            = 1;  // report rates relative to the sensor
+
+  /* Vital signs, MR60BHA2 */
+  float heart_rate     = 72;     // beats per minute
+  float breath_rate    = 16;     // breaths per minute
+  float phase_noise    = 0.02f;  // standard deviation added to every phase
+  float motion_per_min = 1;      // motion artefacts, each lasting 1 to 4 s
+
+  /* Scene, both devices */
+  uint32_t max_people     = 3;    // people counting targets
+  uint32_t cloud_points   = 8;    // point cloud points per person
+  float presence_period_s = 60;   // mean time between presence toggles, 0
+                                  // for someone always present
+  float falls_per_hour    = 6;    // MR60FDA2, each reported for 5 s
+
+  uint32_t response_delay_us = 20000;  // before a request is answered
+  uint32_t seed              = 1;
+} MMWaveEmulatorConfig;
+
+/**
+ * @brief Counters of what the emulator produced.
+ */
+typedef struct MMWaveEmulatorStats {
+  uint64_t bytes;
+  uint32_t frames;
+  uint32_t requests;   // request frames received
+  uint32_t responses;  // acknowledgements and parameter responses sent
+  uint32_t motions;
+  uint32_t falls;
+  uint32_t presence_changes;
+} MMWaveEmulatorStats;
+
+class SeeedmmWaveEmulator {
+ public:
+  explicit SeeedmmWaveEmulator(
+      const MMWaveEmulatorConfig& config = MMWaveEmulatorConfig());
+
+  // Back to time 0 with the scene and random sequence of a fresh emulator
+  void reset();
+
+  const MMWaveEmulatorConfig& config() const {
+    return _config;
+  }
+
+  /**
+   * @brief Append the frames due up to a time to a byte stream.
+   *
+   * @param until_us Virtual time in microseconds, frames due at or before it
+   * are produced in time order.
+   * @param times Optional, receives the time of the frame of every byte
+   * appended, as SeeedmmWaveReplayTransport::load() takes them.
+   * @return The number of frames appended.
+   */
+  size_t generate(int64_t until_us, std::vector<uint8_t>& out,
+                  std::vector<int64_t>* times = nullptr);
+
+  // Time the next frame is due
+  int64_t nextDue() const;
+  int64_t now() const {
+    return _now_us;
+  }
+
+  /**
+   * @brief Bytes written by the library to the sensor.
+   *
+   * Every complete request is answered response_delay_us after time_us, the
+   * way the MR60FDA2 firmware does: with a success flag and the request's
+   * frame ID for a setting, with the current parameters for 0x0E06, and not
+   * at all for the requests the library does not wait on.
+   */
+  void receive(const uint8_t* data, size_t len, int64_t time_us);
+
+  const FallRadarProfile& profile() const {
+    return _profile;
+  }
+  const MMWaveEmulatorStats& stats() const {
+    return _stats;
+  }
+
+ private:
+  typedef struct Person {
+    float x, y;    // metres, the radar at the origin
+    float vx, vy;  // metres per second
+  } Person;
+
+  typedef struct Stream {
+    uint16_t type;
+    uint32_t period_us;  // at rate_scale 1
+    int64_t due_us;
+  } Stream;
+
+  typedef struct Response {
+    int64_t due_us;
+    uint16_t type;
+    uint16_t id;
+    std::vector<uint8_t> payload;
+  } Response;
+
+  void advanceScene(int64_t time_us);
+  size_t report(uint16_t type, int64_t time_us, std::vector<uint8_t>& out);
+  size_t frame(uint16_t type, uint16_t id, const uint8_t* payload,
+               size_t len, std::vector<uint8_t>& out);
+  size_t pointCloud(uint8_t* payload, bool targets);
+  void handleRequest(uint16_t type, uint16_t id, const uint8_t* payload,
+                     size_t len, int64_t time_us);
+
+  float uniform(float low, float high) {
+    return std::uniform_real_distribution<float>(low, high)(_random);
+  }
+  float gaussian(float sigma) {
+    return sigma > 0 ? std::normal_distribution<float>(0, sigma)(_random)
+                     : 0;
+  }
+  // Whether an event with a mean rate per second happens within dt seconds
+  bool chance(float per_s, float dt) {
+    return per_s > 0 && uniform(0, 1) < per_s * dt;
+  }
+
+  MMWaveEmulatorConfig _config;
+  MMWaveEmulatorStats _stats;
+  std::mt19937 _random;
+  std::vector<Stream> _streams;
+  std::deque<Response> _responses;
+  FallRadarProfile _profile;
+
+  int64_t _now_us   = 0;
+  int64_t _scene_us = 0;
+  uint16_t _next_id = 0;
+
+  bool _present            = true;
+  int64_t _motion_until_us = 0;
+  int64_t _fall_until_us   = 0;
+  float _distance          = 0.8f;  // metres, MR60BHA2
+  std::vector<Person> _people;
+
+  // Request being received
+  std::vector<uint8_t> _request;
+};
+
+/**
+ * @brief Transport feeding the emulator's stream to SeeedmmWave on a host.
+ *
+ * Paced, the frames come due with the host clock and wait in an RX buffer
+ * of the ESP32's size until read: whatever does not fit is lost and counted
+ * as overrun, as with a UART driver read too slowly. Unpaced, the virtual
+ * clock jumps to the next frame whenever the buffer is empty, so the library
+ * runs as fast as it can. Either way receiveTime() reports virtual times.
+ * The stream is not limited to the baud rate, so that reports many times the
+ * sensor's can be offered.
+ */
+class SeeedmmWaveEmulatorTransport final : public SeeedmmWaveTransport {
+ public:
+  explicit SeeedmmWaveEmulatorTransport(
+      const MMWaveEmulatorConfig& config = MMWaveEmulatorConfig())
+      : _emulator(config) {}
+
+  SeeedmmWaveEmulator& emulator() {
+    return _emulator;
+  }
+
+  void setPaced(bool paced) {
+    _paced = paced;
+  }
+  void setRxBufferSize(size_t bytes) {
+    _rx_capacity = bytes;
+  }
+  // Virtual time after which the stream ends, 0 for never
+  void setDuration(int64_t duration_us) {
+    _duration_us = duration_us;
+  }
+
+  // Restart the stream and the clock, clearing the counters
+  void rewind();
+  bool finished() const {
+    return _duration_us > 0 && _emulator.now() >= _duration_us &&
+           _fifo.empty();
+  }
+  // Bytes lost to a full RX buffer
+  uint64_t overrun() const {
+    return _overrun;
+  }
+  // Largest number of bytes waiting to be read
+  size_t rxHighWater() const {
+    return _rx_high_water;
+  }
+
+  void begin(uint32_t baud) override {
+    (void)baud;
+  }
+  size_t available() override;
+  size_t read(uint8_t* data, size_t len) override;
+  int64_t receiveTime() override {
+    return _start_us + _read_time_us;
+  }
+
+  size_t availableForWrite() override {
+    return 4096;
+  }
+  size_t write(const uint8_t* data, size_t len) override;
+
+ private:
+  void fill();
+
+  SeeedmmWaveEmulator _emulator;
+  std::vector<uint8_t> _generated;
+  std::vector<int64_t> _generated_times;
+  std::deque<uint8_t> _fifo;
+  std::deque<int64_t> _fifo_times;  // virtual receive time of every byte
+
+  bool _paced           = true;
+  size_t _rx_capacity   = 32768;  // SeeedmmWaveSerialTransport::begin()
+  int64_t _duration_us  = 0;
+  bool _started         = false;
+  int64_t _start_us     = 0;
+  int64_t _read_time_us = 0;
+  uint64_t _overrun     = 0;
+  size_t _rx_high_water = 0;
+};
+
+#endif  // SEEEDMMWAVE_EMULATOR_H
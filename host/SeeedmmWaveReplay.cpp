@@ -0,0 +1,159 @@
+#include "SeeedmmWaveReplay.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+static const char kTimedMagic[] = "# mmwave capture";
+
+bool SeeedmmWaveReplayTransport::open(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr)
+    return false;
+  std::vector<uint8_t> content;
+  uint8_t chunk[4096];
+  size_t got;
+  while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    content.insert(content.end(), chunk, chunk + got);
+  }
+  bool ok = !ferror(file);
+  fclose(file);
+  if (!ok)
+    return false;
+
+  size_t magic = sizeof(kTimedMagic) - 1;
+  if (content.size() >= magic &&
+      memcmp(content.data(), kTimedMagic, magic) == 0)
+    return loadTimed(content);
+  load(content.data(), content.size());
+  return true;
+}
+
+/**
+ * @brief Parse a timed capture, one "<time_us> <hex bytes>" line at a time.
+ *
+ * Every byte of a line gets the time of the line.
+ */
+bool SeeedmmWaveReplayTransport::loadTimed(const std::vector<uint8_t>& text) {
+  std::vector<uint8_t> bytes;
+  std::vector<int64_t> times;
+  std::string line;
+  size_t start = 0;
+  while (start < text.size()) {
+    size_t end = start;
+    while (end < text.size() && text[end] != '\n') {
+      end++;
+    }
+    line.assign(text.begin() + start, text.begin() + end);
+    start = end + 1;
+
+    const char* p = line.c_str();
+    while (isspace((unsigned char)*p)) {
+      p++;
+    }
+    if (*p == '\0' || *p == '#')
+      continue;
+    char* next;
+    long long time_us = strtoll(p, &next, 10);
+    if (next == p)
+      return false;
+    p = next;
+    for (;;) {
+      while (isspace((unsigned char)*p)) {
+        p++;
+      }
+      if (*p == '\0')
+        break;
+      unsigned long byte = strtoul(p, &next, 16);
+      if (next == p || byte > 0xFF)
+        return false;
+      bytes.push_back(uint8_t(byte));
+      times.push_back(time_us);
+      p = next;
+    }
+  }
+  _bytes   = std::move(bytes);
+  _times   = std::move(times);
+  _written.clear();
+  rewind();
+  return true;
+}
+
+void SeeedmmWaveReplayTransport::load(const uint8_t* data, size_t len,
+                                      const int64_t* times) {
+  _bytes.assign(data, data + len);
+  if (times)
+    _times.assign(times, times + len);
+  else
+    _times.clear();
+  _written.clear();
+  rewind();
+}
+
+void SeeedmmWaveReplayTransport::rewind() {
+  _pos     = 0;
+  _started = false;
+}
+
+int64_t SeeedmmWaveReplayTransport::byteTime(size_t index) const {
+  if (!_times.empty())
+    return _times[index] - _times[0];
+  return int64_t(index + 1) * _byte_ns / 1000;
+}
+
+int64_t SeeedmmWaveReplayTransport::duration() const {
+  return _bytes.empty() ? 0 : byteTime(_bytes.size() - 1);
+}
+
+void SeeedmmWaveReplayTransport::begin(uint32_t baud) {
+  // 8N1: ten bit times per byte; raw captures keep the default timing when
+  // the link has no baud rate
+  if (baud)
+    _byte_ns = uint32_t(10000000000ULL / baud);
+}
+
+size_t SeeedmmWaveReplayTransport::available() {
+  if (!_started) {
+    _started  = true;
+    _start_us = esp_timer_get_time();
+  }
+  size_t limit = _bytes.size() - _pos;
+  if (limit > _read_chunk)
+    limit = _read_chunk;
+  if (_speed <= 0)
+    return limit;
+
+  // Everything recorded up to the capture time reached at this speed
+  int64_t reached = int64_t((esp_timer_get_time() - _start_us) * _speed);
+  size_t ready    = 0;
+  if (_times.empty()) {
+    size_t bytes = size_t(reached * 1000 / _byte_ns);
+    ready        = bytes > _pos ? bytes - _pos : 0;
+  } else {
+    while (ready < limit && byteTime(_pos + ready) <= reached) {
+      ready++;
+    }
+  }
+  return ready < limit ? ready : limit;
+}
+
+size_t SeeedmmWaveReplayTransport::read(uint8_t* data, size_t len) {
+  size_t ready = available();
+  if (len > ready)
+    len = ready;
+  memcpy(data, _bytes.data() + _pos, len);
+  _pos += len;
+  return len;
+}
+
+int64_t SeeedmmWaveReplayTransport::receiveTime() {
+  return _start_us + (_pos ? byteTime(_pos - 1) : 0);
+}
+
+size_t SeeedmmWaveReplayTransport::write(const uint8_t* data, size_t len) {
+  _written.insert(_written.end(), data, data + len);
+  return len;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file SeeedmmWaveReplay.h
+ *
+ * @note Transport feeding a recorded UART capture to SeeedmmWave on a host.
+ *
+ * Two capture formats are read:
+ *
+ * - Raw: the bytes exactly as received from the sensor, e.g. saved with
+ *   `cat /dev/ttyUSB0 > capture.bin`. Without timing, the bytes are taken to
+ *   have arrived back to back at the baud rate given to begin().
+ * - Timed: a text file whose first line is "# mmwave capture". Every other
+ *   line not starting with '#' is a receive time in microseconds followed
+ *   by the bytes received then, in hex:
+ *
+ *       # mmwave capture
+ *       1000250 01 00 01 00 04 0A 15 EE 00 00 70 42 8D
+ *
+ * The capture is paced against the host clock at a chosen speed, or handed
+ * out as fast as it is read. Either way receiveTime() reports the recorded
+ * times, so frame timestamps and intervals match the original session.
+ */
+
+#ifndef SEEEDMMWAVE_REPLAY_H
+#define SEEEDMMWAVE_REPLAY_H
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "SeeedmmWaveTransport.h"
+
+class SeeedmmWaveReplayTransport final : public SeeedmmWaveTransport {
+ public:
+  SeeedmmWaveReplayTransport() {}
+
+  /**
+   * @brief Load a capture file, raw or timed.
+   *
+   * @retval false The file cannot be read or a timed line is malformed.
+   */
+  bool open(const char* path);
+
+  /**
+   * @brief Replace the capture with bytes in memory.
+   *
+   * @param times Optional, the receive time of every byte in microseconds.
+   */
+  void load(const uint8_t* data, size_t len, const int64_t* times = nullptr);
+
+  /**
+   * @brief Replay speed relative to the recording: 1 is real time, 10 ten
+   * times faster, 0 (the default) as fast as the bytes are read.
+   */
+  void setSpeed(double speed) {
+    _speed = speed;
+  }
+  double speed() const {
+    return _speed;
+  }
+
+  /**
+   * @brief Most bytes one read() returns, like a UART driver handing over
+   * its FIFO in pieces. An unpaced replay otherwise delivers the whole
+   * capture at once, and the receive ring would have to evict most of it.
+   */
+  void setReadChunk(size_t bytes) {
+    _read_chunk = bytes ? bytes : 1;
+  }
+
+  // Replay from the start again, with the clock restarting on the next read
+  void rewind();
+
+  bool finished() const {
+    return _pos == _bytes.size();
+  }
+  const uint8_t* data() const {
+    return _bytes.data();
+  }
+  size_t size() const {
+    return _bytes.size();
+  }
+  size_t position() const {
+    return _pos;
+  }
+  // Time covered by the capture in microseconds
+  int64_t duration() const;
+
+  void begin(uint32_t baud) override;
+  size_t available() override;
+  size_t read(uint8_t* data, size_t len) override;
+  int64_t receiveTime() override;
+
+  // Whatever the library sends is kept for inspection
+  size_t availableForWrite() override {
+    return 4096;
+  }
+  size_t write(const uint8_t* data, size_t len) override;
+  const std::vector<uint8_t>& written() const {
+    return _written;
+  }
+
+ private:
+  int64_t byteTime(size_t index) const;
+  bool loadTimed(const std::vector<uint8_t>& text);
+
+  std::vector<uint8_t> _bytes;
+  std::vector<int64_t> _times;  // per byte, empty for a raw capture
+  std::vector<uint8_t> _written;
+  size_t _pos        = 0;
+  size_t _read_chunk = 120;    // HardwareSerial RX FIFO full threshold
+  uint32_t _byte_ns  = 86806;  // 115200 baud, 8N1
+  double _speed      = 0;
+  bool _started      = false;
+  int64_t _start_us  = 0;  // esp_timer time the replay started
+};
+
+#endif  // SEEEDMMWAVE_REPLAY_H
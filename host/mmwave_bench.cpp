@@ -0,0 +1,692 @@
+/**
+ * @file mmwave_bench.cpp
+ *
+ * @note Host microbenchmarks of the mmWave receive path.
+ *
+ *   mmwave_bench [-f filter] [-t seconds] [-o results.json] [capture...]
+ *
+ * Every benchmark runs one pass over a corpus of frames repeatedly for at
+ * least the minimum time, and reports ns/byte, ns/frame and frames/s. The
+ * framing and fetch benchmarks also report the frames per pass that passed
+ * both checksums against the intact frames of the corpus, the recovered
+ * ratio, when the corpus knows how many it holds:
+ *
+ * - framing/ring: SeeedmmWaveParser alone, fed in UART FIFO sized chunks.
+ * - framing/legacy: the byte-wise framer fetch() used before the ring
+ *   parser, kept here as the reference, with the checksums processFrame()
+ *   checked afterwards.
+ * - checksum/processFrame: processFrame() on whole frames, stopping after
+ *   the checksums.
+ * - fetch/static, fetch/virtual: fetch() and processQueuedFrames() from a
+ *   replayed capture, through SeeedmmWaveT or the virtual handleType().
+ * - decode/<report>/static|virtual: one SEEED_MR60BHA2::handleType branch.
+ * - codec/phases/wire|reinterpret_cast: decoding a phase report with
+ *   MMWavePayload, or with the unaligned loads it replaced.
+ *
+ * The synthetic corpora are vital sign reports, point clouds that fit the
+ * queue, point clouds that get truncated, vital signs with bit errors, vital
+ * signs behind line noise full of false SOFs, and a minute of an emulated
+ * MR60BHA2 (see SeeedmmWaveEmulator.h). Captures
+ * given on the command line (see SeeedmmWaveReplay.h) are added as corpora
+ * named after the file. Results are written as JSON so that runs
+ * before and after a change can be compared.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "SeeedmmWaveEmulator.h"
+#include "SeeedmmWaveReplay.h"
+#include "Seeed_Arduino_mmWave.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// Bytes handed over per read, as by the UART driver with its default RX
+// FIFO full threshold
+static const size_t kChunk = 120;
+
+// Handler calls per pass of the decode benchmarks
+static const size_t kDecodeCalls = 1000;
+
+// Keeps a value the compiler would otherwise drop as unused
+template <typename T>
+static inline void keep(const T& value) {
+  asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Hides the dynamic type so that calls through the pointer stay virtual
+template <typename T>
+static inline T* opaque(T* pointer) {
+  asm volatile("" : "+r"(pointer));
+  return pointer;
+}
+
+class BenchSensor : public SEEED_MR60BHA2 {
+ public:
+  using SeeedmmWave::packetFrame;
+  using SeeedmmWave::processFrame;
+};
+
+typedef struct Corpus {
+  std::string name;
+  std::vector<uint8_t> bytes;
+  // Where each frame starts and its length, synthetic corpora only
+  std::vector<std::pair<size_t, size_t>> frames;
+  size_t intact = 0;  // frames without bit errors, 0 when unknown
+} Corpus;
+
+typedef struct BenchResult {
+  std::string name;
+  std::string corpus;
+  uint64_t iterations;
+  uint64_t bytes;   // per pass
+  uint64_t frames;  // per pass, only those passing the checksums for the
+                    // framing and fetch benchmarks
+  uint64_t intact;  // frames of the corpus that could be recovered, 0 when
+                    // unknown or not applicable
+  double seconds;
+} BenchResult;
+
+static double g_min_time    = 0.2;
+static const char* g_filter = nullptr;
+static std::vector<BenchResult> g_results;
+
+/* Corpora */
+
+// Deterministic, so that runs compare
+static uint32_t g_seed = 1;
+static uint32_t nextRandom() {
+  g_seed = g_seed * 1664525 + 1013904223;
+  return g_seed >> 8;
+}
+
+static float randomFloat(float low, float high) {
+  return low + (high - low) * float(nextRandom() & 0xFFFF) / 65535.0f;
+}
+
+static void appendFrame(Corpus& corpus, uint16_t type, const uint8_t* payload,
+                        size_t len) {
+  static BenchSensor builder;
+  static uint16_t id = 0;
+  std::vector<uint8_t> frame(SIZE_FRAME_HEADER + len + SIZE_DATA_CKSUM);
+  size_t size = builder.packetFrame(type, id++, payload, len, frame.data());
+  corpus.frames.push_back({corpus.bytes.size(), size});
+  corpus.bytes.insert(corpus.bytes.end(), frame.begin(),
+                      frame.begin() + size);
+  corpus.intact++;
+}
+
+template <typename Payload, typename... Fields>
+static void appendReport(Corpus& corpus, TypeHeartBreath type,
+                         Fields... values) {
+  uint8_t payload[Payload::kSize];
+  Payload::encode(payload, values...);
+  appendFrame(corpus, static_cast<uint16_t>(type), payload, sizeof(payload));
+}
+
+static size_t pointCloudPayload(uint8_t* payload, uint32_t targets) {
+  MMWaveWire<uint32_t>::encode(targets, payload);
+  uint8_t* point = payload + sizeof(uint32_t);
+  for (uint32_t i = 0; i < targets; i++, point += MMWAVE_POINT_SIZE) {
+    MMWaveWire<float>::encode(randomFloat(-3, 3), point);
+    MMWaveWire<float>::encode(randomFloat(0, 6), point + 4);
+    MMWaveWire<int32_t>::encode(int32_t(i % 16) - 8, point + 8);
+    MMWaveWire<int32_t>::encode(int32_t(i % 4), point + 12);
+  }
+  return point - payload;
+}
+
+static void appendPointCloud(Corpus& corpus, TypeHeartBreath type,
+                             uint32_t targets) {
+  std::vector<uint8_t> payload(sizeof(uint32_t) +
+                               targets * MMWAVE_POINT_SIZE);
+  pointCloudPayload(payload.data(), targets);
+  appendFrame(corpus, static_cast<uint16_t>(type), payload.data(),
+              payload.size());
+}
+
+// One cycle of every vital sign report, as the MR60BHA2 sends them
+static void appendVitals(Corpus& corpus) {
+  appendReport<HeartBreathPayload>(
+      corpus, TypeHeartBreath::TypeHeartBreathPhase, randomFloat(-1, 1),
+      randomFloat(-1, 1), randomFloat(-1, 1));
+  appendReport<MMWaveFloatPayload>(corpus, TypeHeartBreath::TypeBreathRate,
+                                   randomFloat(10, 25));
+  appendReport<MMWaveFloatPayload>(corpus, TypeHeartBreath::TypeHeartRate,
+                                   randomFloat(55, 95));
+  appendReport<RangePayload>(corpus,
+                             TypeHeartBreath::TypeHeartBreathDistance,
+                             uint32_t(1), randomFloat(0.3f, 1.5f));
+  appendReport<MMWaveFlagPayload>(
+      corpus, TypeHeartBreath::ReportHumanDetection, uint8_t(1));
+}
+
+static Corpus vitalsCorpus() {
+  Corpus corpus;
+  corpus.name = "vitals";
+  for (int i = 0; i < 2000; i++) {
+    appendVitals(corpus);
+  }
+  return corpus;
+}
+
+// Target lists that are queued whole, between vital sign reports
+static Corpus pointCloudCorpus() {
+  Corpus corpus;
+  corpus.name = "pointcloud";
+  for (int i = 0; i < 300; i++) {
+    appendPointCloud(corpus, TypeHeartBreath::Report3DPointCloudTargetInfo,
+                     1 + i % 30);
+    appendVitals(corpus);
+  }
+  return corpus;
+}
+
+// Point clouds longer than MMWAVE_MAX_PAYLOAD, queued truncated
+static Corpus largePointCloudCorpus() {
+  Corpus corpus;
+  corpus.name = "pointcloud_large";
+  for (int i = 0; i < 100; i++) {
+    appendPointCloud(corpus, TypeHeartBreath::Report3DPointCloudDetection,
+                     100);
+    appendVitals(corpus);
+  }
+  return corpus;
+}
+
+// Flip a bit every mean_gap bytes on average, at most one per frame so
+// that no frame survives a pair of flips by chance
+static void flipBits(Corpus& corpus, size_t mean_gap) {
+  size_t pos   = 0;
+  size_t frame = 0;
+  for (;;) {
+    pos += 1 + nextRandom() % (2 * mean_gap);
+    if (pos >= corpus.bytes.size())
+      break;
+    corpus.bytes[pos] ^= uint8_t(1 << (nextRandom() % 8));
+    while (frame < corpus.frames.size() &&
+           corpus.frames[frame].first + corpus.frames[frame].second <= pos) {
+      frame++;
+    }
+    // Noise between frames loses nothing
+    if (frame == corpus.frames.size() || pos < corpus.frames[frame].first)
+      continue;
+    corpus.intact--;
+    pos = corpus.frames[frame].first + corpus.frames[frame].second;
+  }
+}
+
+// Vital signs with a bit flipped every 2 KB on average
+static Corpus corruptedCorpus() {
+  Corpus corpus = vitalsCorpus();
+  corpus.name   = "corrupted";
+  flipBits(corpus, 2048);
+  return corpus;
+}
+
+// Vital signs on a noisy line: before one frame in eight a burst of stray
+// bytes starting with a false SOF, and a bit flipped every 512 bytes
+static Corpus noisyCorpus() {
+  Corpus clean = vitalsCorpus();
+  Corpus corpus;
+  corpus.name = "noisy";
+  for (const auto& frame : clean.frames) {
+    if (nextRandom() % 8 == 0) {
+      size_t len = 1 + nextRandom() % 12;
+      for (size_t i = 0; i < len; i++) {
+        bool sof = i == 0 || nextRandom() % 4 == 0;
+        corpus.bytes.push_back(sof ? SOF_BYTE : uint8_t(nextRandom()));
+      }
+    }
+    corpus.frames.push_back({corpus.bytes.size(), frame.second});
+    corpus.bytes.insert(corpus.bytes.end(),
+                        clean.bytes.begin() + frame.first,
+                        clean.bytes.begin() + frame.first + frame.second);
+  }
+  corpus.intact = corpus.frames.size();
+  flipBits(corpus, 512);
+  return corpus;
+}
+
+// A minute of an MR60BHA2 with people coming and going
+static Corpus emulatedCorpus() {
+  Corpus corpus;
+  corpus.name = "emulated";
+  SeeedmmWaveEmulator emulator;
+  corpus.intact = emulator.generate(60000000, corpus.bytes);
+  return corpus;
+}
+
+static bool loadCapture(const char* path, Corpus& corpus) {
+  SeeedmmWaveReplayTransport capture;
+  if (!capture.open(path))
+    return false;
+  const char* name = strrchr(path, '/');
+  corpus.name      = name ? name + 1 : path;
+  corpus.bytes.assign(capture.data(), capture.data() + capture.size());
+  return true;
+}
+
+/* Measurement */
+
+/**
+ * @param recovers The pass returns the frames passing the checksums, to be
+ * compared with the intact frames of the corpus.
+ */
+template <typename Pass>
+static void measure(const char* name, const Corpus& corpus, Pass&& pass,
+                    bool recovers = false) {
+  std::string full = std::string(name) + "/" + corpus.name;
+  if (g_filter && full.find(g_filter) == std::string::npos)
+    return;
+
+  // Warm-up, also giving the work done by one pass
+  uint64_t bytes  = corpus.bytes.size();
+  uint64_t frames = pass(bytes);
+
+  uint64_t iterations = 0;
+  Clock::time_point start = Clock::now();
+  double seconds;
+  do {
+    pass(bytes);
+    iterations++;
+    seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  } while (seconds < g_min_time);
+
+  uint64_t intact = recovers ? corpus.intact : 0;
+  g_results.push_back(
+      {name, corpus.name, iterations, bytes, frames, intact, seconds});
+  double passes = double(iterations);
+  fprintf(stderr,
+          "%-40s %-16s %8.2f ns/byte %9.1f ns/frame %12.0f frames/s %8" PRIu64
+          " frames",
+          name, corpus.name.c_str(),
+          bytes ? seconds * 1e9 / (passes * bytes) : 0.0,
+          frames ? seconds * 1e9 / (passes * frames) : 0.0,
+          seconds > 0 ? passes * frames / seconds : 0.0, frames);
+  if (intact) {
+    fprintf(stderr, " of %8" PRIu64 " intact, %6.2f%% recovered", intact,
+            100.0 * frames / intact);
+  }
+  fprintf(stderr, "\n");
+}
+
+// Both checksums of a whole frame match, as processFrame() checks them
+static bool checksumsMatch(const std::vector<uint8_t>& frame) {
+  size_t data_len = (frame[3] << 8) | frame[4];
+  if (frame.size() != SIZE_FRAME_HEADER + data_len + SIZE_DATA_CKSUM)
+    return false;
+  uint8_t cksum = 0;
+  for (size_t i = 0; i < SIZE_FRAME_HEADER - SIZE_HEAD_CKSUM; i++) {
+    cksum ^= frame[i];
+  }
+  if (uint8_t(~cksum) != frame[SIZE_FRAME_HEADER - SIZE_HEAD_CKSUM])
+    return false;
+  cksum = 0;
+  for (size_t i = 0; i < data_len; i++) {
+    cksum ^= frame[SIZE_FRAME_HEADER + i];
+  }
+  return uint8_t(~cksum) == frame[SIZE_FRAME_HEADER + data_len];
+}
+
+/**
+ * @brief The framer fetch() used before the ring parser.
+ *
+ * One read() call per byte, every frame copied into a vector in a queue of
+ * vectors, payloads over 30 bytes discarded, checksums left to
+ * processFrame(). Frames corrupted or started on a false SOF are queued all
+ * the same and only fail there.
+ */
+class LegacyFramer {
+ public:
+  // Frames queued from the bytes
+  size_t feed(const uint8_t* data, size_t len) {
+    size_t queued = 0;
+    _src          = data;
+    _end          = data + len;
+    size_t count  = len;
+    while (count--) {
+      uint8_t byte = read();
+      if (_start) {
+        _frame.push_back(byte);
+        if (_frame.size() >= SIZE_FRAME_HEADER) {
+          uint8_t size = (_frame[3] << 8 | _frame[4]);
+          if (size > 30) {
+            _start = false;
+            continue;
+          }
+          if (_frame.size() ==
+              size_t(SIZE_FRAME_HEADER + size + SIZE_DATA_CKSUM)) {
+            if (_queue.size() >= MMWaveMaxQueueSize)
+              _queue.pop();
+            _queue.push(_frame);
+            _start = false;
+            queued++;
+          }
+        }
+      } else if (byte == SOF_BYTE) {
+        _start = true;
+        _frame.clear();
+        _frame.push_back(byte);
+      }
+    }
+    return queued;
+  }
+
+  // processQueuedFrames() took a copy of the front frame, returns the
+  // frames that passed the checksums
+  size_t drain() {
+    size_t valid = 0;
+    while (!_queue.empty()) {
+      std::vector<uint8_t> frame = _queue.front();
+      _queue.pop();
+      if (checksumsMatch(frame))
+        valid++;
+    }
+    return valid;
+  }
+
+ private:
+  // Stands for HardwareSerial::read(), an out of line call per byte
+  __attribute__((noinline)) uint8_t read() {
+    return _src < _end ? *_src++ : 0;
+  }
+
+  const uint8_t* _src = nullptr;
+  const uint8_t* _end = nullptr;
+  bool _start         = false;
+  std::vector<uint8_t> _frame;
+  std::queue<std::vector<uint8_t>> _queue;
+};
+
+static void benchFraming(const Corpus& corpus) {
+  std::unique_ptr<SeeedmmWaveParser> parser(new SeeedmmWaveParser());
+  measure("framing/ring", corpus, [&](uint64_t& bytes) {
+    uint64_t frames = 0;
+    size_t pos      = 0;
+    parser->reset();
+    while (pos < bytes) {
+      size_t room;
+      uint8_t* dst = parser->writeBuffer(room);
+      size_t len   = bytes - pos;
+      if (len > kChunk)
+        len = kChunk;
+      if (len > room)
+        len = room;
+      memcpy(dst, corpus.bytes.data() + pos, len);
+      parser->commit(len);
+      pos += len;
+      while (parser->next()) {
+      }
+      // Only frames whose checksums matched are queued
+      while (!parser->empty()) {
+        keep(parser->front());
+        parser->pop();
+        frames++;
+      }
+    }
+    return frames;
+  }, true);
+
+  LegacyFramer legacy;
+  measure("framing/legacy", corpus, [&](uint64_t& bytes) {
+    uint64_t frames = 0;
+    for (size_t pos = 0; pos < bytes; pos += kChunk) {
+      size_t len = bytes - pos < kChunk ? bytes - pos : kChunk;
+      legacy.feed(corpus.bytes.data() + pos, len);
+      frames += legacy.drain();
+    }
+    return frames;
+  }, true);
+}
+
+static void benchChecksum(const Corpus& corpus) {
+  if (corpus.frames.empty())
+    return;
+  std::unique_ptr<BenchSensor> sensor(new BenchSensor());
+  measure("checksum/processFrame", corpus, [&](uint64_t&) {
+    for (const auto& frame : corpus.frames) {
+      // No frame has this type: processFrame() returns after the checksums
+      bool valid = sensor->processFrame(corpus.bytes.data() + frame.first,
+                                        frame.second, 0xFFFE);
+      keep(valid);
+    }
+    return uint64_t(corpus.frames.size());
+  });
+}
+
+template <typename Sensor>
+static void benchFetch(const char* name, const Corpus& corpus) {
+  SeeedmmWaveReplayTransport capture;
+  capture.load(corpus.bytes.data(), corpus.bytes.size());
+  capture.setReadChunk(kChunk);
+  std::unique_ptr<Sensor> sensor(new Sensor());
+  sensor->begin(&capture);
+  measure(name, corpus, [&](uint64_t&) {
+    uint32_t before = sensor->getParserStats().frames;
+    capture.rewind();
+    while (!capture.finished()) {
+      sensor->fetch(0);
+      sensor->processQueuedFrames();
+    }
+    return uint64_t(sensor->getParserStats().frames - before);
+  }, true);
+}
+
+// One report of each row of MR60BHA2_FRAME_TABLE
+typedef struct DecodeCase {
+  const char* name;
+  uint16_t type;
+  size_t size;  // payload size, point clouds are sized separately
+} DecodeCase;
+
+static const DecodeCase kDecodeCases[] = {
+#define X(name, type, payload, handler) {#name, type, payload::kSize},
+    MR60BHA2_FRAME_TABLE(X)
+#undef X
+};
+
+static void benchDecode() {
+  Corpus corpus;
+  corpus.name = "synthetic";
+  std::unique_ptr<BenchSensor> sensor(new BenchSensor());
+  for (const DecodeCase& decode : kDecodeCases) {
+    uint8_t payload[MMWAVE_MAX_PAYLOAD] = {};
+    size_t len                          = decode.size;
+    if (decode.type == uint16_t(TypeHeartBreath::Report3DPointCloudTargetInfo) ||
+        decode.type == uint16_t(TypeHeartBreath::Report3DPointCloudDetection))
+      len = pointCloudPayload(payload, 30);
+    else
+      for (size_t i = 0; i < len; i++) {
+        payload[i] = uint8_t(nextRandom());
+      }
+    MMWaveFrameView view(payload, len);
+    corpus.bytes.assign(payload, payload + len);
+
+    std::string name = std::string("decode/") + decode.name;
+    measure((name + "/static").c_str(), corpus, [&](uint64_t& bytes) {
+      bytes = len * kDecodeCalls;
+      for (size_t i = 0; i < kDecodeCalls; i++) {
+        bool handled =
+            sensor->SEEED_MR60BHA2::handleType(decode.type, view);
+        keep(handled);
+      }
+      return uint64_t(kDecodeCalls);
+    });
+    measure((name + "/virtual").c_str(), corpus, [&](uint64_t& bytes) {
+      bytes = len * kDecodeCalls;
+      for (size_t i = 0; i < kDecodeCalls; i++) {
+        bool handled = opaque<SEEED_MR60BHA2>(sensor.get())
+                           ->handleType(decode.type, view);
+        keep(handled);
+      }
+      return uint64_t(kDecodeCalls);
+    });
+  }
+}
+
+static void benchCodec() {
+  Corpus corpus;
+  corpus.name = "phases";
+  // Payloads one byte off alignment, as in the receive ring
+  const size_t reports = 1024;
+  corpus.bytes.assign(1 + reports * HeartBreathPayload::kSize, 0);
+  for (size_t i = 0; i < reports; i++) {
+    HeartBreathPayload::encode(&corpus.bytes[1 + i * HeartBreathPayload::kSize],
+                               randomFloat(-1, 1), randomFloat(-1, 1),
+                               randomFloat(-1, 1));
+  }
+  const uint8_t* base = corpus.bytes.data() + 1;
+
+  measure("codec/wire", corpus, [&](uint64_t&) {
+    for (size_t i = 0; i < reports; i++) {
+      HeartBreath phases;
+      HeartBreathPayload::decode(base + i * HeartBreathPayload::kSize,
+                                 HeartBreathPayload::kSize, phases);
+      keep(phases);
+    }
+    return uint64_t(reports);
+  });
+  // What extractFloat() did before MMWaveWire: misaligned, and only right
+  // on a little-endian host
+  measure("codec/reinterpret_cast", corpus, [&](uint64_t&) {
+    for (size_t i = 0; i < reports; i++) {
+      const uint8_t* data = base + i * HeartBreathPayload::kSize;
+      HeartBreath phases;
+      phases.total_phase  = *reinterpret_cast<const float*>(data);
+      phases.breath_phase = *reinterpret_cast<const float*>(data + 4);
+      phases.heart_phase  = *reinterpret_cast<const float*>(data + 8);
+      keep(phases);
+    }
+    return uint64_t(reports);
+  });
+}
+
+/* Output */
+
+static void writeJsonString(FILE* out, const std::string& text) {
+  fputc('"', out);
+  for (char c : text) {
+    if (c == '"' || c == '\\')
+      fputc('\\', out);
+    if ((unsigned char)c < 0x20)
+      fprintf(out, "\\u%04x", c);
+    else
+      fputc(c, out);
+  }
+  fputc('"', out);
+}
+
+static void writeJson(FILE* out) {
+  fprintf(out, "{\n  \"schema\": \"mmwave-bench/2\",\n");
+  fprintf(out, "  \"compiler\": ");
+  writeJsonString(out, __VERSION__);
+  fprintf(out, ",\n  \"min_time_s\": %g,\n  \"results\": [\n", g_min_time);
+  for (size_t i = 0; i < g_results.size(); i++) {
+    const BenchResult& result = g_results[i];
+    double passes             = double(result.iterations);
+    double ns                 = result.seconds * 1e9;
+    fprintf(out, "    {\"name\": ");
+    writeJsonString(out, result.name);
+    fprintf(out, ", \"corpus\": ");
+    writeJsonString(out, result.corpus);
+    fprintf(out,
+            ", \"iterations\": %" PRIu64 ", \"bytes\": %" PRIu64
+            ", \"frames\": %" PRIu64 ", \"intact\": %" PRIu64,
+            result.iterations, result.bytes, result.frames, result.intact);
+    // null when the corpus does not know its intact frames
+    if (result.intact)
+      fprintf(out, ", \"recovered_ratio\": %.6f",
+              double(result.frames) / result.intact);
+    else
+      fprintf(out, ", \"recovered_ratio\": null");
+    fprintf(out,
+            ", \"seconds\": %.6f, \"ns_per_byte\": %.3f"
+            ", \"ns_per_frame\": %.3f, \"frames_per_s\": %.1f}%s\n",
+            result.seconds, result.bytes ? ns / (passes * result.bytes) : 0.0,
+            result.frames ? ns / (passes * result.frames) : 0.0,
+            result.seconds > 0 ? passes * result.frames / result.seconds : 0.0,
+            i + 1 < g_results.size() ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+}
+
+static void usage(const char* name) {
+  fprintf(stderr,
+          "usage: %s [-f filter] [-t seconds] [-o results.json] "
+          "[capture...]\n"
+          "  -f  only run the benchmarks whose name/corpus contains filter\n"
+          "  -t  minimum time per benchmark (default 0.2 s)\n"
+          "  -o  write the JSON results there instead of stdout\n",
+          name);
+}
+
+int main(int argc, char** argv) {
+  const char* output = nullptr;
+  int opt;
+  while ((opt = getopt(argc, argv, "f:t:o:h")) != -1) {
+    switch (opt) {
+      case 'f':
+        g_filter = optarg;
+        break;
+      case 't':
+        g_min_time = atof(optarg);
+        break;
+      case 'o':
+        output = optarg;
+        break;
+      default:
+        usage(argv[0]);
+        return 2;
+    }
+  }
+
+  std::vector<Corpus> corpora;
+  corpora.push_back(vitalsCorpus());
+  corpora.push_back(pointCloudCorpus());
+  corpora.push_back(largePointCloudCorpus());
+  corpora.push_back(corruptedCorpus());
+  corpora.push_back(noisyCorpus());
+  corpora.push_back(emulatedCorpus());
+  for (int i = optind; i < argc; i++) {
+    Corpus corpus;
+    if (!loadCapture(argv[i], corpus)) {
+      fprintf(stderr, "%s: cannot read capture %s\n", argv[0], argv[i]);
+      return 1;
+    }
+    corpora.push_back(std::move(corpus));
+  }
+
+  for (const Corpus& corpus : corpora) {
+    if (!corpus.frames.empty()) {
+      fprintf(stderr, "corpus %s: %zu bytes, %zu frames, %zu intact\n",
+              corpus.name.c_str(), corpus.bytes.size(), corpus.frames.size(),
+              corpus.intact);
+    }
+    benchFraming(corpus);
+    benchChecksum(corpus);
+    benchFetch<SeeedmmWaveT<BenchSensor>>("fetch/static", corpus);
+    benchFetch<BenchSensor>("fetch/virtual", corpus);
+  }
+  benchDecode();
+  benchCodec();
+
+  FILE* out = output ? fopen(output, "w") : stdout;
+  if (out == nullptr) {
+    fprintf(stderr, "%s: cannot write %s\n", argv[0], output);
+    return 1;
+  }
+  writeJson(out);
+  if (output)
+    fclose(out);
+  return 0;
+}
@@ -0,0 +1,437 @@
+/**
+ * @file mmwave_emulator.cpp
+ *
+ * @note Load and soak test the mmWave library against an emulated sensor.
+ *
+ *   mmwave_emulator [-d bha2|fda2] [-r rate] [-t seconds] [-H bpm] [-B bpm]
+ *                   [-n noise] [-m motions] [-p people] [-f falls] [-x seed]
+ *                   [-w us] [-c ms] [-a rounds] [-u] [-S]
+ *                   [-o capture [-T] [-P]]
+ *
+ * By default the emulated stream is fed in real time to the same parser,
+ * queue and decoders as on the ESP32, with optional application work per
+ * loop, and what was offered is compared with what was handled. -S repeats
+ * the run doubling the report rate until frames are lost, to find the rate
+ * each configuration sustains; -u runs unpaced to find the library's own
+ * ceiling. -a configures an emulated MR60FDA2 with the four setters one after
+ * the other, then with applyProfile(), and compares the times. With -o the
+ * stream is written to a capture for mmwave_replay and
+ * mmwave_bench instead, or, paced with -P, to a serial port wired to an
+ * ESP32 running the application.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "SeeedmmWaveEmulator.h"
+#include "Seeed_Arduino_mmWave.h"
+
+typedef struct EmulatorOptions {
+  MMWaveEmulatorConfig config;
+  double seconds      = 10;
+  uint32_t work_us    = 0;  // application work per loop
+  uint32_t command_ms = 0;  // MR60FDA2 request interval, 0 for none
+  uint32_t rounds     = 0;  // setters against applyProfile(), 0 for none
+  bool unpaced        = false;
+  bool sweep          = false;
+  const char* capture = nullptr;
+  bool timed          = false;
+  bool paced_capture  = false;
+} EmulatorOptions;
+
+typedef struct CommandLoad {
+  uint32_t sent;
+  uint32_t acked;
+  uint32_t failed;
+  int64_t sent_us;
+  int64_t latency_sum_us;
+  int64_t latency_max_us;
+  bool pending;
+} CommandLoad;
+
+typedef struct RunResult {
+  uint32_t offered;  // frames generated
+  uint32_t handled;  // frames queued by the parser
+  uint32_t lost;     // offered but not queued, or queued and dropped
+  uint64_t overrun;  // bytes lost to the RX buffer
+  double seconds;
+} RunResult;
+
+static void onCommand(uint16_t id, MMWaveCommandStatus status,
+                      const MMWaveRecord* response, void* ctx) {
+  (void)id;
+  (void)response;
+  CommandLoad& load = *static_cast<CommandLoad*>(ctx);
+  load.pending      = false;
+  if (status != MMWaveCommandStatus::Acked) {
+    load.failed++;
+    return;
+  }
+  int64_t latency_us = esp_timer_get_time() - load.sent_us;
+  load.acked++;
+  load.latency_sum_us += latency_us;
+  if (latency_us > load.latency_max_us)
+    load.latency_max_us = latency_us;
+}
+
+// Stands for the application's own processing of each loop
+static void work(uint32_t us) {
+  int64_t until_us = esp_timer_get_time() + us;
+  while (esp_timer_get_time() < until_us) {
+  }
+}
+
+static void sendCommand(SEEED_MR60BHA2& sensor, CommandLoad& load) {
+  (void)sensor;
+  (void)load;
+}
+
+static void sendCommand(SEEED_MR60FDA2& sensor, CommandLoad& load) {
+  // Alternate between two heights so that each request changes the setting
+  float height = load.sent % 2 ? 2.2f : 2.5f;
+  load.sent_us = esp_timer_get_time();
+  if (sensor.setInstallationHeightAsync(height, onCommand, &load) < 0) {
+    load.failed++;
+    return;
+  }
+  load.sent++;
+  load.pending = true;
+}
+
+template <typename Device>
+static RunResult run(const EmulatorOptions& options, float rate_scale,
+                     bool verbose) {
+  MMWaveEmulatorConfig config = options.config;
+  config.rate_scale           = rate_scale;
+  SeeedmmWaveEmulatorTransport transport(config);
+  transport.setPaced(!options.unpaced);
+  transport.setDuration(int64_t(options.seconds * 1e6));
+
+  SeeedmmWaveT<Device> sensor;
+  sensor.begin(&transport);
+  CommandLoad commands     = {};
+  uint32_t last_command_ms = millis();
+
+  int64_t start_us = esp_timer_get_time();
+  while (!transport.finished()) {
+    if (transport.available() == 0 && !options.unpaced) {
+      delay(1);
+    } else {
+      sensor.fetch(0);
+      sensor.processQueuedFrames();
+    }
+    if (options.work_us)
+      work(options.work_us);
+    if (options.command_ms && !commands.pending &&
+        millis() - last_command_ms >= options.command_ms) {
+      last_command_ms = millis();
+      sendCommand(sensor, commands);
+    }
+  }
+  // Let the last command complete or time out
+  while (commands.pending) {
+    sensor.fetch(0);
+    sensor.processQueuedFrames();
+    delay(1);
+  }
+
+  const MMWaveEmulatorStats& emulated = transport.emulator().stats();
+  const MMWaveParserStats& parser     = sensor.getParserStats();
+  RunResult result;
+  result.offered = emulated.frames;
+  result.handled = parser.frames - parser.evicted;
+  result.lost    = result.offered > result.handled
+                       ? result.offered - result.handled
+                       : 0;
+  result.overrun = transport.overrun();
+  result.seconds = (esp_timer_get_time() - start_us) / 1e6;
+
+  if (verbose) {
+    printf("emulated %" PRIu32 " frames, %" PRIu64
+           " bytes: %" PRIu32 " motions, %" PRIu32 " falls, %" PRIu32
+           " presence changes\n",
+           emulated.frames, emulated.bytes, emulated.motions, emulated.falls,
+           emulated.presence_changes);
+    printf("handled %" PRIu32 " frames, lost %" PRIu32 " (RX overrun %" PRIu64
+           " bytes, RX buffer high water %zu bytes)\n",
+           result.handled, result.lost, result.overrun,
+           transport.rxHighWater());
+    printf("parser: checksum errors %" PRIu32 "/%" PRIu32
+           ", oversize %" PRIu32 ", evicted %" PRIu32 ", overflowed %" PRIu32
+           ", ID gaps %" PRIu32 "\n",
+           parser.header_errors, parser.data_errors, parser.oversize,
+           parser.evicted, parser.overflowed, parser.id_gaps);
+    if (commands.sent) {
+      printf("commands: %" PRIu32 " sent, %" PRIu32 " acknowledged, %" PRIu32
+             " failed",
+             commands.sent, commands.acked, commands.failed);
+      if (commands.acked) {
+        printf(", latency %" PRId64 " us (max %" PRId64 ")",
+               commands.latency_sum_us / commands.acked,
+               commands.latency_max_us);
+      }
+      printf("\n");
+    }
+    const FetchStats& fetch = sensor.getFetchStats(sensor.getFetchMode());
+    if (fetch.bytes && fetch.dispatched) {
+      // Cycles are nanoseconds on the host
+      printf("framing %.1f ns/byte, dispatch %.0f ns/frame\n",
+             double(fetch.parse_cycles) / fetch.bytes,
+             double(fetch.dispatch_cycles) / fetch.dispatched);
+    }
+    printf("%.0f frames/s offered, %.0f handled in %.3f s\n",
+           result.offered / options.seconds,
+           result.seconds > 0 ? result.handled / result.seconds : 0.0,
+           result.seconds);
+  }
+  return result;
+}
+
+/**
+ * @brief Double the report rate until frames are lost.
+ */
+template <typename Device>
+static int sweep(const EmulatorOptions& options) {
+  float rate      = options.config.rate_scale;
+  float sustained = 0;
+  for (int step = 0; step < 20; step++, rate *= 2) {
+    RunResult result = run<Device>(options, rate, false);
+    printf("rate x%-8g %9.0f frames/s offered, %" PRIu32 " lost\n", rate,
+           result.offered / options.seconds, result.lost);
+    fflush(stdout);
+    if (result.lost)
+      break;
+    sustained = rate;
+  }
+  if (sustained > 0)
+    printf("sustained up to x%g the sensor's report rate\n", sustained);
+  else
+    printf("frames lost from x%g already\n", options.config.rate_scale);
+  return 0;
+}
+
+/**
+ * @brief Time the four MR60FDA2 setters, each waiting for its acknowledgement,
+ * against applyProfile() pipelining them after one parameter read.
+ *
+ * Every round sets one profile with the setters and the other with
+ * applyProfile(), so that each changes all four settings.
+ */
+static int compareProfile(const EmulatorOptions& options) {
+  MMWaveEmulatorConfig config = options.config;
+  config.device               = MMWaveEmulatedDevice::MR60FDA2;
+  SeeedmmWaveEmulatorTransport transport(config);
+  SeeedmmWaveT<SEEED_MR60FDA2> sensor;
+  sensor.begin(&transport);
+
+  const FallRadarProfile profiles[2] = {
+      {2.2f, 0.6f, 3, 0.5f, 0.5f, 0.5f, 0.5f},
+      {2.6f, 0.8f, 5, 1.0f, 1.0f, 1.0f, 1.0f},
+  };
+  int64_t sequential_us = 0, applied_us = 0;
+  uint32_t failed = 0;
+  for (uint32_t round = 0; round < options.rounds; round++) {
+    const FallRadarProfile& first  = profiles[round % 2];
+    const FallRadarProfile& second = profiles[(round + 1) % 2];
+
+    int64_t start_us = esp_timer_get_time();
+    bool ok = sensor.setInstallationHeight(first.height) &&
+              sensor.setThreshold(first.threshold) &&
+              sensor.setSensitivity(first.sensitivity) &&
+              sensor.setAlamArea(first.rect_XL, first.rect_XR,
+                                 first.rect_ZF, first.rect_ZB);
+    sequential_us += esp_timer_get_time() - start_us;
+    if (!ok)
+      failed++;
+
+    FallRadarApplyResult result = {};
+    if (!sensor.applyProfile(second, &result) || result.changed != 4)
+      failed++;
+    applied_us += result.elapsed_us;
+  }
+
+  const FallRadarProfile& profile = transport.emulator().profile();
+  printf("%" PRIu32 " rounds, %" PRIu32 " failed, response delay %" PRIu32
+         " us\n",
+         options.rounds, failed, config.response_delay_us);
+  printf("four setters:   %8.0f us per profile\n",
+         double(sequential_us) / options.rounds);
+  printf("applyProfile(): %8.0f us per profile\n",
+         double(applied_us) / options.rounds);
+  printf("sensor left at height %.1f, threshold %.1f, sensitivity %" PRIu32
+         "\n",
+         profile.height, profile.threshold, profile.sensitivity);
+  return failed ? 1 : 0;
+}
+
+/**
+ * @brief Write the stream to a file, raw or in the timed capture format.
+ */
+static int writeCapture(const EmulatorOptions& options) {
+  bool to_stdout = strcmp(options.capture, "-") == 0;
+  FILE* out      = to_stdout ? stdout : fopen(options.capture, "wb");
+  if (out == nullptr) {
+    fprintf(stderr, "cannot write %s\n", options.capture);
+    return 1;
+  }
+  if (options.timed)
+    fprintf(out, "# mmwave capture\n");
+
+  SeeedmmWaveEmulator emulator(options.config);
+  int64_t duration_us = int64_t(options.seconds * 1e6);
+  int64_t start_us    = esp_timer_get_time();
+  std::vector<uint8_t> bytes;
+  std::vector<int64_t> times;
+  while (emulator.now() < duration_us) {
+    int64_t until = emulator.nextDue();
+    if (until > duration_us)
+      until = duration_us;
+    if (options.paced_capture) {
+      int64_t wait_us = start_us + until - esp_timer_get_time();
+      if (wait_us > 0)
+        usleep(wait_us);
+    }
+    bytes.clear();
+    times.clear();
+    emulator.generate(until, bytes, &times);
+    if (options.timed) {
+      // One line per receive time
+      for (size_t i = 0; i < bytes.size(); i++) {
+        if (i == 0 || times[i] != times[i - 1])
+          fprintf(out, "%s%" PRId64, i ? "\n" : "", times[i]);
+        fprintf(out, " %02X", bytes[i]);
+      }
+      if (!bytes.empty())
+        fprintf(out, "\n");
+    } else {
+      fwrite(bytes.data(), 1, bytes.size(), out);
+    }
+    if (options.paced_capture)
+      fflush(out);
+  }
+
+  const MMWaveEmulatorStats& stats = emulator.stats();
+  fprintf(stderr, "%" PRIu32 " frames, %" PRIu64 " bytes over %.1f s\n",
+          stats.frames, stats.bytes, options.seconds);
+  if (!to_stdout)
+    fclose(out);
+  return 0;
+}
+
+template <typename Device>
+static int emulate(const EmulatorOptions& options) {
+  if (options.sweep)
+    return sweep<Device>(options);
+  run<Device>(options, options.config.rate_scale, true);
+  return 0;
+}
+
+static void usage(const char* name) {
+  fprintf(stderr,
+          "usage: %s [-d bha2|fda2] [-r rate] [-t seconds] [-H bpm] [-B bpm] "
+          "[-n noise] [-m motions] [-p people] [-f falls] [-x seed] [-w us] "
+          "[-c ms] [-a rounds] [-u] [-S] [-o capture [-T] [-P]]\n"
+          "  -r  report rate relative to the sensor (default 1)\n"
+          "  -t  seconds of sensor time (default 10)\n"
+          "  -H  heart rate, -B breath rate, per minute\n"
+          "  -n  phase noise, -m motion artefacts per minute\n"
+          "  -p  most people in the room, -f falls per hour\n"
+          "  -w  application work per loop in microseconds\n"
+          "  -c  MR60FDA2 request every that many milliseconds\n"
+          "  -a  time the MR60FDA2 setters against applyProfile()\n"
+          "  -u  unpaced, as fast as the library reads\n"
+          "  -S  double the rate until frames are lost\n"
+          "  -o  write the stream to a file instead, '-' for stdout\n"
+          "  -T  in the timed capture format, -P paced in real time\n",
+          name);
+}
+
+int main(int argc, char** argv) {
+  EmulatorOptions options;
+  MMWaveEmulatorConfig& config = options.config;
+  int opt;
+  while ((opt = getopt(argc, argv, "d:r:t:H:B:n:m:p:f:x:w:c:a:uSo:TPh")) !=
+         -1) {
+    switch (opt) {
+      case 'd':
+        if (strcmp(optarg, "bha2") == 0) {
+          config.device = MMWaveEmulatedDevice::MR60BHA2;
+        } else if (strcmp(optarg, "fda2") == 0) {
+          config.device = MMWaveEmulatedDevice::MR60FDA2;
+        } else {
+          usage(argv[0]);
+          return 2;
+        }
+        break;
+      case 'r':
+        config.rate_scale = atof(optarg);
+        break;
+      case 't':
+        options.seconds = atof(optarg);
+        break;
+      case 'H':
+        config.heart_rate = atof(optarg);
+        break;
+      case 'B':
+        config.breath_rate = atof(optarg);
+        break;
+      case 'n':
+        config.phase_noise = atof(optarg);
+        break;
+      case 'm':
+        config.motion_per_min = atof(optarg);
+        break;
+      case 'p':
+        config.max_people = strtoul(optarg, nullptr, 10);
+        break;
+      case 'f':
+        config.falls_per_hour = atof(optarg);
+        break;
+      case 'x':
+        config.seed = strtoul(optarg, nullptr, 10);
+        break;
+      case 'w':
+        options.work_us = strtoul(optarg, nullptr, 10);
+        break;
+      case 'c':
+        options.command_ms = strtoul(optarg, nullptr, 10);
+        break;
+      case 'a':
+        options.rounds = strtoul(optarg, nullptr, 10);
+        break;
+      case 'u':
+        options.unpaced = true;
+        break;
+      case 'S':
+        options.sweep = true;
+        break;
+      case 'o':
+        options.capture = optarg;
+        break;
+      case 'T':
+        options.timed = true;
+        break;
+      case 'P':
+        options.paced_capture = true;
+        break;
+      default:
+        usage(argv[0]);
+        return 2;
+    }
+  }
+  if (optind != argc || options.seconds <= 0 || config.rate_scale <= 0) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  if (options.capture)
+    return writeCapture(options);
+  if (options.rounds)
+    return compareProfile(options);
+  if (config.device == MMWaveEmulatedDevice::MR60FDA2)
+    return emulate<SEEED_MR60FDA2>(options);
+  return emulate<SEEED_MR60BHA2>(options);
+}
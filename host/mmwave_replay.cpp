@@ -0,0 +1,174 @@
+/**
+ * @file mmwave_replay.cpp
+ *
+ * @note Replay a UART capture through the mmWave library on a host.
+ *
+ *   mmwave_replay [-d bha2|fda2] [-s speed] [-b baud] [-c chunk] [-l loops]
+ *                 [-v] capture
+ *
+ * The capture goes through the same parser, frame queue and handleType()
+ * decoders as on the ESP32, then the reception counters and the decoding
+ * throughput are printed. See SeeedmmWaveReplay.h for the capture formats.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "SeeedmmWaveReplay.h"
+#include "Seeed_Arduino_mmWave.h"
+
+typedef struct ReplayOptions {
+  const char* device = "bha2";
+  double speed       = 0;
+  uint32_t baud      = _UART_BAUD;
+  uint32_t chunk     = 120;
+  uint32_t loops     = 1;
+  bool verbose       = false;
+} ReplayOptions;
+
+static void printRecord(const MMWaveRecord& record, void* ctx) {
+  (void)ctx;
+  printf("%" PRId64 " id %04X type %04X len %u:", record.timestamp_us,
+         record.id, record.type, record.data_len);
+  for (uint8_t i = 0; i < record.words; i++) {
+    printf(" %08" PRIX32, record.value[i].u);
+  }
+  printf("%s\n", record.truncated ? " ..." : "");
+}
+
+static void printStats(const SeeedmmWave& sensor) {
+  const MMWaveParserStats& parser = sensor.getParserStats();
+  printf("bytes %" PRIu64 ", frames %" PRIu32 "\n", parser.bytes,
+         parser.frames);
+  printf("checksum errors: header %" PRIu32 ", data %" PRIu32 "\n",
+         parser.header_errors, parser.data_errors);
+  printf("dropped: oversize %" PRIu32 ", evicted %" PRIu32
+         ", overflowed %" PRIu32 "\n",
+         parser.oversize, parser.evicted, parser.overflowed);
+  printf("frame ID gaps %" PRIu32 ", IDs missed %" PRIu32 "\n",
+         parser.id_gaps, parser.ids_missed);
+
+  size_t count;
+  const MMWaveTypeStats* types = sensor.getTypeStats(count);
+  for (size_t i = 0; i < count; i++) {
+    const MMWaveTypeStats& type = types[i];
+    printf("type %04X: %" PRIu32 " accepted, %" PRIu32 " truncated, %" PRIu32
+           " dropped, %" PRIu32 " skipped, %" PRIu32 " coalesced",
+           type.type, type.accepted, type.truncated, type.dropped,
+           type.skipped, type.coalesced);
+    if (type.intervals) {
+      printf(", interval %" PRIu64 " us (%" PRIu32 "-%" PRIu32 ")",
+             type.interval_sum_us / type.intervals, type.interval_min_us,
+             type.interval_max_us);
+    }
+    printf("\n");
+  }
+}
+
+template <typename Device>
+static int replay(SeeedmmWaveReplayTransport& capture,
+                  const ReplayOptions& options) {
+  SeeedmmWaveT<Device> sensor;
+  sensor.begin(&capture, options.baud);
+  if (options.verbose) {
+    sensor.subscribe(MMWAVE_ANY_TYPE, printRecord);
+  }
+
+  int64_t start_us = esp_timer_get_time();
+  for (uint32_t loop = 0; loop < options.loops; loop++) {
+    capture.rewind();
+    while (!capture.finished()) {
+      if (capture.available() == 0) {
+        // Paced replay ahead of the recording
+        delay(1);
+        continue;
+      }
+      sensor.fetch(0);
+      sensor.processQueuedFrames();
+    }
+  }
+  int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+  printStats(sensor);
+  // Cycles are nanoseconds on the host
+  const FetchStats& fetch = sensor.getFetchStats(sensor.getFetchMode());
+  double seconds          = elapsed_us / 1e6;
+  double recorded         = capture.duration() * options.loops / 1e6;
+  printf("replayed %.3f s of capture in %.3f s (%.1fx real time)\n",
+         recorded, seconds, seconds > 0 ? recorded / seconds : 0.0);
+  if (options.speed <= 0 && seconds > 0) {
+    printf("%.0f frames/s, %.0f bytes/s\n",
+           sensor.getParserStats().frames / seconds, fetch.bytes / seconds);
+  }
+  if (fetch.bytes && fetch.dispatched) {
+    printf("framing %.1f ns/byte, dispatch %.0f ns/frame (%" PRIu32
+           "-%" PRIu32 ")\n",
+           double(fetch.parse_cycles) / fetch.bytes,
+           double(fetch.dispatch_cycles) / fetch.dispatched,
+           fetch.dispatch_cycles_min, fetch.dispatch_cycles_max);
+  }
+  return 0;
+}
+
+static void usage(const char* name) {
+  fprintf(stderr,
+          "usage: %s [-d bha2|fda2] [-s speed] [-b baud] [-c chunk] "
+          "[-l loops] [-v] capture\n"
+          "  -s  replay speed, 1 for real time, 0 (default) unpaced\n"
+          "  -c  most bytes read at once (default 120)\n"
+          "  -l  replay the capture this many times\n"
+          "  -v  print every decoded frame\n",
+          name);
+}
+
+int main(int argc, char** argv) {
+  ReplayOptions options;
+  int opt;
+  while ((opt = getopt(argc, argv, "d:s:b:c:l:vh")) != -1) {
+    switch (opt) {
+      case 'd':
+        options.device = optarg;
+        break;
+      case 's':
+        options.speed = atof(optarg);
+        break;
+      case 'b':
+        options.baud = strtoul(optarg, nullptr, 10);
+        break;
+      case 'c':
+        options.chunk = strtoul(optarg, nullptr, 10);
+        break;
+      case 'l':
+        options.loops = strtoul(optarg, nullptr, 10);
+        break;
+      case 'v':
+        options.verbose = true;
+        break;
+      default:
+        usage(argv[0]);
+        return 2;
+    }
+  }
+  if (optind != argc - 1 || options.baud == 0) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  SeeedmmWaveReplayTransport capture;
+  if (!capture.open(argv[optind])) {
+    fprintf(stderr, "%s: cannot read capture %s\n", argv[0], argv[optind]);
+    return 1;
+  }
+  capture.setSpeed(options.speed);
+  capture.setReadChunk(options.chunk);
+
+  if (strcmp(options.device, "bha2") == 0)
+    return replay<SEEED_MR60BHA2>(capture, options);
+  if (strcmp(options.device, "fda2") == 0)
+    return replay<SEEED_MR60FDA2>(capture, options);
+  usage(argv[0]);
+  return 2;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file Arduino.h
+ *
+ * @note The part of the Arduino core the mmWave library uses, for host
+ * builds. Time comes from the host clock, GPIO calls do nothing, and Serial
+ * prints to stdout.
+ */
+
+#ifndef MMWAVE_HOST_ARDUINO_H
+#define MMWAVE_HOST_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define HEX 16
+#define DEC 10
+
+#define LOW    0
+#define HIGH   1
+#define INPUT  0
+#define OUTPUT 1
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+
+/**
+ * @brief Console behind Serial; there is no UART on the host, sensors are
+ * reached through a SeeedmmWaveTransport.
+ */
+class HostSerial {
+ public:
+  void begin(unsigned long baud) {
+    (void)baud;
+  }
+  void print(const char* text);
+  void print(int value, int base = DEC);
+  void println(const char* text = "");
+  void println(int value, int base = DEC);
+  void printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HostSerial Serial;
+
+#endif  // MMWAVE_HOST_ARDUINO_H
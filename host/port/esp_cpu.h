@@ -0,0 +1,10 @@
+#ifndef MMWAVE_HOST_ESP_CPU_H
+#define MMWAVE_HOST_ESP_CPU_H
+
+#include <stdint.h>
+
+// Host builds count one cycle per nanosecond of the monotonic clock, so the
+// cycle statistics read as nanoseconds
+uint32_t esp_cpu_get_cycle_count(void);
+
+#endif  // MMWAVE_HOST_ESP_CPU_H
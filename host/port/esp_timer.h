@@ -0,0 +1,9 @@
+#ifndef MMWAVE_HOST_ESP_TIMER_H
+#define MMWAVE_HOST_ESP_TIMER_H
+
+#include <stdint.h>
+
+// Microseconds since the process started, from the monotonic host clock
+int64_t esp_timer_get_time(void);
+
+#endif  // MMWAVE_HOST_ESP_TIMER_H
@@ -0,0 +1,47 @@
+/**
+ * @file FreeRTOS.h
+ *
+ * @note The FreeRTOS subset used by the mmWave library, implemented over
+ * std::thread for host builds. The tick is one millisecond. Critical
+ * sections are process wide spin locks, and tasks are plain threads with a
+ * notification counter.
+ */
+
+#ifndef MMWAVE_HOST_FREERTOS_H
+#define MMWAVE_HOST_FREERTOS_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdFAIL  0
+#define pdPASS  1
+
+#define configTICK_RATE_HZ   1000
+#define configMAX_PRIORITIES 25
+#define portTICK_PERIOD_MS   (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY        ((TickType_t)0xFFFFFFFF)
+#define pdMS_TO_TICKS(ms)                                                      \
+  ((TickType_t)((uint64_t)(ms) * configTICK_RATE_HZ / 1000))
+
+typedef struct portMUX_TYPE {
+  std::atomic<int> locked;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)  vPortExitCritical(mux)
+
+#endif  // MMWAVE_HOST_FREERTOS_H
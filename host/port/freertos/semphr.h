@@ -0,0 +1,19 @@
+#ifndef MMWAVE_HOST_SEMPHR_H
+#define MMWAVE_HOST_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+// Binary semaphore; the storage is also the handle
+typedef struct StaticSemaphore {
+  std::mutex mutex;
+  std::condition_variable cond;
+  bool given = false;
+} StaticSemaphore_t;
+
+typedef StaticSemaphore_t* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* buffer);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+
+#endif  // MMWAVE_HOST_SEMPHR_H
@@ -0,0 +1,29 @@
+#ifndef MMWAVE_HOST_TASK_H
+#define MMWAVE_HOST_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void* arg);
+typedef struct HostTask* TaskHandle_t;
+
+/**
+ * @brief Run the task in a new detached thread. Priority and stack size are
+ * ignored.
+ */
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name,
+                       uint32_t stack_size, void* arg, UBaseType_t priority,
+                       TaskHandle_t* handle);
+
+/**
+ * @brief Only vTaskDelete(nullptr) is supported. It cannot stop the calling
+ * thread, which ends when the task function returns.
+ */
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+#endif  // MMWAVE_HOST_TASK_H
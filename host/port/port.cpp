@@ -0,0 +1,178 @@
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "Arduino.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static const Clock::time_point kStart = Clock::now();
+
+int64_t esp_timer_get_time(void) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                               kStart)
+      .count();
+}
+
+uint32_t esp_cpu_get_cycle_count(void) {
+  return uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      Clock::now() - kStart)
+                      .count());
+}
+
+unsigned long millis() {
+  return esp_timer_get_time() / 1000;
+}
+
+unsigned long micros() {
+  return esp_timer_get_time();
+}
+
+void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void pinMode(int, int) {}
+void digitalWrite(int, int) {}
+
+HostSerial Serial;
+
+void HostSerial::print(const char* text) {
+  fputs(text, stdout);
+}
+
+void HostSerial::print(int value, int base) {
+  ::printf(base == HEX ? "%X" : "%d", value);
+}
+
+void HostSerial::println(const char* text) {
+  puts(text);
+}
+
+void HostSerial::println(int value, int base) {
+  print(value, base);
+  putchar('\n');
+}
+
+void HostSerial::printf(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+}
+
+void vPortEnterCritical(portMUX_TYPE* mux) {
+  while (mux->locked.exchange(1, std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+}
+
+void vPortExitCritical(portMUX_TYPE* mux) {
+  mux->locked.store(0, std::memory_order_release);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* buffer) {
+  std::lock_guard<std::mutex> lock(buffer->mutex);
+  buffer->given = false;
+  return buffer;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  std::lock_guard<std::mutex> lock(semaphore->mutex);
+  if (semaphore->given)
+    return pdFALSE;
+  semaphore->given = true;
+  semaphore->cond.notify_one();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(semaphore->mutex);
+  auto given = [semaphore]() { return semaphore->given; };
+  if (ticks == portMAX_DELAY) {
+    semaphore->cond.wait(lock, given);
+  } else if (!semaphore->cond.wait_for(
+                 lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS),
+                 given)) {
+    return pdFALSE;
+  }
+  semaphore->given = false;
+  return pdTRUE;
+}
+
+struct HostTask {
+  std::mutex mutex;
+  std::condition_variable cond;
+  uint32_t notifications = 0;
+};
+
+// Threads not started by xTaskCreate() get their task state on first use
+static thread_local HostTask* t_task = nullptr;
+static thread_local std::unique_ptr<HostTask> t_adopted;
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char*, uint32_t,
+                       void* arg, UBaseType_t, TaskHandle_t* handle) {
+  HostTask* task = new HostTask();
+  if (handle)
+    *handle = task;
+  std::thread([function, arg, task]() {
+    std::unique_ptr<HostTask> owner(task);
+    t_task = task;
+    function(arg);
+  }).detach();
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t) {}
+
+void vTaskDelay(TickType_t ticks) {
+  if (ticks == 0) {
+    std::this_thread::yield();
+  } else {
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+  }
+}
+
+TickType_t xTaskGetTickCount(void) {
+  return TickType_t(millis() / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+  if (t_task == nullptr) {
+    t_adopted.reset(new HostTask());
+    t_task = t_adopted.get();
+  }
+  return t_task;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  std::lock_guard<std::mutex> lock(task->mutex);
+  task->notifications++;
+  task->cond.notify_one();
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+  HostTask* task = xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> lock(task->mutex);
+  auto notified  = [task]() { return task->notifications != 0; };
+  if (ticks == portMAX_DELAY) {
+    task->cond.wait(lock, notified);
+  } else {
+    task->cond.wait_for(
+        lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), notified);
+  }
+  uint32_t count = task->notifications;
+  if (count)
+    task->notifications = clear_on_exit ? 0 : count - 1;
+  return count;
+}
@@ -0,0 +1,48 @@
+# Smoke run of mmwave_bench, checking the JSON it writes against the
+# mmwave-bench/2 schema:
+#
+#   cmake -DBENCH=mmwave_bench -DOUTPUT=results.json -P check_bench_json.cmake
+cmake_minimum_required(VERSION 3.19)
+
+execute_process(COMMAND ${BENCH} -t 0.01 -o ${OUTPUT}
+                RESULT_VARIABLE status ERROR_QUIET)
+if(NOT status EQUAL 0)
+  message(FATAL_ERROR "mmwave_bench failed: ${status}")
+endif()
+
+file(READ ${OUTPUT} json)
+string(JSON schema GET "${json}" schema)
+if(NOT schema STREQUAL "mmwave-bench/2")
+  message(FATAL_ERROR "unexpected schema ${schema}")
+endif()
+
+string(JSON count LENGTH "${json}" results)
+if(count EQUAL 0)
+  message(FATAL_ERROR "no results")
+endif()
+math(EXPR last "${count} - 1")
+set(framing 0)
+foreach(i RANGE ${last})
+  foreach(key name corpus iterations bytes frames intact recovered_ratio
+              seconds ns_per_byte ns_per_frame frames_per_s)
+    string(JSON value ERROR_VARIABLE error GET "${json}" results ${i} ${key})
+    if(error)
+      message(FATAL_ERROR "result ${i}: ${error}")
+    endif()
+  endforeach()
+  string(JSON name GET "${json}" results ${i} name)
+  string(JSON corpus GET "${json}" results ${i} corpus)
+  string(JSON intact GET "${json}" results ${i} intact)
+  string(JSON frames GET "${json}" results ${i} frames)
+  # The ring framer recovers every intact frame of the synthetic corpora
+  if(name STREQUAL "framing/ring" AND intact GREATER 0)
+    math(EXPR framing "${framing} + 1")
+    if(NOT frames EQUAL intact)
+      message(FATAL_ERROR "framing/ring on ${corpus}: ${frames} of ${intact} intact frames")
+    endif()
+  endif()
+endforeach()
+if(framing EQUAL 0)
+  message(FATAL_ERROR "no framing/ring result with intact frames")
+endif()
+message(STATUS "${count} results")
@@ -0,0 +1,82 @@
+/**
+ * @file mmwave_test.h
+ *
+ * @note Minimal checks for the host tests, run by ctest.
+ */
+
+#ifndef MMWAVE_TEST_H
+#define MMWAVE_TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "SeeedmmWaveParser.h"
+
+static int g_test_failures = 0;
+
+#define CHECK(condition)                                                \
+  do {                                                                  \
+    if (!(condition)) {                                                 \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+              #condition);                                              \
+      g_test_failures++;                                                \
+    }                                                                   \
+  } while (0)
+
+// A frame as the sensor sends it, both checksums included
+static inline std::vector<uint8_t> buildFrame(
+    uint16_t id, uint16_t type, const std::vector<uint8_t>& payload) {
+  std::vector<uint8_t> frame = {SOF_BYTE,
+                                uint8_t(id >> 8),
+                                uint8_t(id),
+                                uint8_t(payload.size() >> 8),
+                                uint8_t(payload.size()),
+                                uint8_t(type >> 8),
+                                uint8_t(type)};
+  uint8_t cksum = 0;
+  for (uint8_t byte : frame) {
+    cksum ^= byte;
+  }
+  frame.push_back(~cksum);
+  cksum = 0;
+  for (uint8_t byte : payload) {
+    cksum ^= byte;
+  }
+  frame.insert(frame.end(), payload.begin(), payload.end());
+  frame.push_back(~cksum);
+  return frame;
+}
+
+// Bytes the parser took, short when the ring is full
+static inline size_t feed(SeeedmmWaveParser& parser,
+                          const std::vector<uint8_t>& bytes) {
+  size_t done = 0;
+  while (done < bytes.size()) {
+    size_t room;
+    uint8_t* dst = parser.writeBuffer(room);
+    if (room == 0)
+      break;
+    size_t len = bytes.size() - done;
+    if (len > room)
+      len = room;
+    memcpy(dst, bytes.data() + done, len);
+    parser.commit(len);
+    done += len;
+    while (parser.next()) {
+    }
+  }
+  return done;
+}
+
+static inline int testResult(const char* name) {
+  if (g_test_failures)
+    fprintf(stderr, "%s: %d checks failed\n", name, g_test_failures);
+  else
+    printf("%s: ok\n", name);
+  return g_test_failures ? 1 : 0;
+}
+
+#endif  // MMWAVE_TEST_H
@@ -0,0 +1,70 @@
+/**
+ * @file test_command_reentry.cpp
+ *
+ * @note waitCommand() called while a frame is handled returns at once
+ * instead of processing frames again under the pinned one.
+ */
+
+#include <vector>
+
+#include "SeeedmmWaveReplay.h"
+#include "Seeed_Arduino_mmWave.h"
+#include "mmwave_test.h"
+
+typedef struct Context {
+  SeeedmmWave* sensor;
+  int32_t id;
+  MMWaveCommandStatus status;
+  uint32_t wait_ms;
+  uint32_t handled;
+} Context;
+
+static void waitInHandler(const MMWaveRecord& record, void* arg) {
+  Context* context = static_cast<Context*>(arg);
+  (void)record;
+  context->handled++;
+  if (context->handled > 1)
+    return;
+  context->id      = context->sensor->sendCommand(0x0E06);
+  uint32_t start   = millis();
+  context->status  = context->sensor->waitCommand(uint16_t(context->id));
+  context->wait_ms = millis() - start;
+  // Nor may the handler run the frame loop itself
+  CHECK(!context->sensor->update(0));
+}
+
+int main() {
+  std::vector<uint8_t> stream;
+  for (uint16_t id = 0; id < 3; id++) {
+    std::vector<uint8_t> payload(sizeof(float));
+    MMWaveFloatPayload::encode(payload.data(), 70.0f);
+    std::vector<uint8_t> frame = buildFrame(
+        id, static_cast<uint16_t>(TypeHeartBreath::TypeHeartRate), payload);
+    stream.insert(stream.end(), frame.begin(), frame.end());
+  }
+  SeeedmmWaveReplayTransport capture;
+  capture.load(stream.data(), stream.size());
+
+  SeeedmmWaveT<SEEED_MR60BHA2> sensor;
+  sensor.begin(&capture);
+  Context context = {&sensor, -1, MMWaveCommandStatus::Unknown, 0, 0};
+  sensor.subscribe(TypeHeartBreath::TypeHeartRate, waitInHandler, &context);
+
+  while (!capture.finished()) {
+    sensor.fetch(0);
+    sensor.processQueuedFrames();
+  }
+
+  CHECK(context.handled == 3);
+  CHECK(context.id >= 0);
+  CHECK(context.status == MMWaveCommandStatus::Pending);
+  CHECK(context.wait_ms < 100);
+  CHECK(sensor.getParserStats().frames == 3);
+
+  // Outside the frame loop the command is waited for as usual, the replay
+  // never answers it
+  CHECK(sensor.waitCommand(uint16_t(context.id)) ==
+        MMWaveCommandStatus::Timeout);
+
+  return testResult("test_command_reentry");
+}
@@ -0,0 +1,142 @@
+/**
+ * @file test_frame_tables.cpp
+ *
+ * @note The layouts of MR60BHA2_FRAME_TABLE and MR60FDA2_FRAME_TABLE match
+ * the payload lengths of the sensor protocol, and the MR60FDA2 requests go
+ * out as frames of the length the protocol gives.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "SeeedmmWaveReplay.h"
+#include "Seeed_Arduino_mmWave.h"
+#include "mmwave_test.h"
+
+// Payload lengths of the protocol, written out independently of the tables
+typedef struct ProtocolFrame {
+  uint16_t type;
+  size_t report;  // shortest report or response accepted
+  int request;    // request payload, -1 for frames never sent
+} ProtocolFrame;
+
+static const ProtocolFrame kMR60BHA2[] = {
+    {0x0A04, 4, -1},   // target count, then the targets
+    {0x0A08, 4, -1},   // point count, then the points
+    {0x0A13, 12, -1},  // total, breath and heart phase
+    {0x0A14, 4, -1},   // breath rate
+    {0x0A15, 4, -1},   // heart rate
+    {0x0A16, 8, -1},   // range flag and range
+    {0x0F09, 1, -1},   // human detected
+    {0xFFFF, 4, -1},   // firmware version
+};
+
+static const ProtocolFrame kMR60FDA2[] = {
+    {0x010E, 0, 4},    // user log on or off
+    {0x0A04, 4, -1},   // target count, then the targets
+    {0x0A08, 4, -1},   // point count, then the points
+    {0x0E02, 1, -1},   // fall detected
+    {0x0E04, 1, 4},    // height, acknowledged by a flag
+    {0x0E06, 28, 0},   // height, threshold, sensitivity and alarm area
+    {0x0E08, 1, 4},    // fall threshold
+    {0x0E0A, 1, 4},    // fall sensitivity
+    {0x0E0C, 1, 16},   // alarm area
+    {0x0E0E, 0, -1},   // height upload
+    {0x0F09, 1, -1},   // human present
+    {0x2110, 0, 0},    // reset to the defaults
+};
+
+template <size_t N>
+static const ProtocolFrame* findFrame(const ProtocolFrame (&frames)[N],
+                                      uint16_t type) {
+  for (const ProtocolFrame& frame : frames) {
+    if (frame.type == type)
+      return &frame;
+  }
+  return nullptr;
+}
+
+template <size_t N>
+static void checkReport(const ProtocolFrame (&frames)[N], uint16_t type,
+                        size_t size) {
+  const ProtocolFrame* frame = findFrame(frames, type);
+  CHECK(frame != nullptr);
+  if (frame && frame->report != size) {
+    fprintf(stderr, "type 0x%04X: layout of %zu bytes, protocol %zu\n", type,
+            size, frame->report);
+    g_test_failures++;
+  }
+}
+
+template <size_t N>
+static void checkRequest(const ProtocolFrame (&frames)[N], uint16_t type,
+                         size_t size) {
+  const ProtocolFrame* frame = findFrame(frames, type);
+  if (frame && size != size_t(std::max(frame->request, 0))) {
+    fprintf(stderr, "type 0x%04X: request layout of %zu bytes, protocol %d\n",
+            type, size, frame->request);
+    g_test_failures++;
+  }
+}
+
+// Payload length of every frame written, by type
+static std::vector<size_t> sentLengths(const std::vector<uint8_t>& written,
+                                       uint16_t type) {
+  std::vector<size_t> lengths;
+  size_t pos = 0;
+  while (pos + SIZE_FRAME_HEADER <= written.size()) {
+    CHECK(written[pos] == SOF_BYTE);
+    size_t len = (size_t(written[pos + 3]) << 8) | written[pos + 4];
+    uint16_t frame_type = uint16_t((written[pos + 5] << 8) | written[pos + 6]);
+    // A payload is followed by its checksum, an empty one by nothing
+    size_t size = SIZE_FRAME_HEADER + len + (len ? SIZE_DATA_CKSUM : 0);
+    CHECK(pos + size <= written.size());
+    if (frame_type == type)
+      lengths.push_back(len);
+    pos += size;
+  }
+  CHECK(pos == written.size());
+  return lengths;
+}
+
+int main() {
+#define X(name, type, payload, handler)                                        \
+  checkReport(kMR60BHA2, type, payload::kSize);
+  MR60BHA2_FRAME_TABLE(X)
+#undef X
+#define X(name, type, payload, handler, request)                               \
+  checkReport(kMR60FDA2, type, payload::kSize);                                \
+  checkRequest(kMR60FDA2, type, request::kSize);
+  MR60FDA2_FRAME_TABLE(X)
+#undef X
+
+  // Every request the MR60FDA2 can send, through its public calls
+  SeeedmmWaveReplayTransport transport;
+  SeeedmmWaveT<SEEED_MR60FDA2> sensor;
+  sensor.begin(&transport);
+  CHECK(sensor.setUserLog(true));
+  int32_t height_id = sensor.setInstallationHeightAsync(2.2f);
+  CHECK(height_id >= 0);
+  CHECK(sensor.setThresholdAsync(0.6f) >= 0);
+  CHECK(sensor.setSensitivityAsync(3) >= 0);
+  CHECK(sensor.setAlamAreaAsync(0.5f, 0.5f, 0.5f, 0.5f) >= 0);
+  // Nothing answers, a timed out command frees its slot for the fifth
+  CHECK(sensor.waitCommand(uint16_t(height_id)) ==
+        MMWaveCommandStatus::Timeout);
+  CHECK(sensor.getRadarParametersAsync() >= 0);
+  CHECK(sensor.resetSetting());
+
+  for (const ProtocolFrame& frame : kMR60FDA2) {
+    std::vector<size_t> lengths = sentLengths(transport.written(), frame.type);
+    CHECK(lengths.size() == (frame.request < 0 ? 0u : 1u));
+    for (size_t len : lengths) {
+      if (int(len) != frame.request) {
+        fprintf(stderr, "type 0x%04X: %zu bytes sent, protocol %d\n",
+                frame.type, len, frame.request);
+        g_test_failures++;
+      }
+    }
+  }
+
+  return testResult("test_frame_tables");
+}
@@ -0,0 +1,115 @@
+/**
+ * @file test_no_alloc.cpp
+ *
+ * @note Frame reception makes no heap call once running: fetch() and
+ * processQueuedFrames() over an emulated MR60BHA2 stream are counted
+ * through operator new and, linked with --wrap, malloc and friends.
+ */
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <new>
+#include <vector>
+
+#include "SeeedmmWaveEmulator.h"
+#include "SeeedmmWaveReplay.h"
+#include "Seeed_Arduino_mmWave.h"
+#include "mmwave_test.h"
+
+static std::atomic<bool> g_counting{false};
+static std::atomic<uint32_t> g_heap_calls{0};
+
+static inline void countHeapCall() {
+  if (g_counting.load(std::memory_order_relaxed))
+    g_heap_calls++;
+}
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+
+void* __wrap_malloc(size_t size) {
+  countHeapCall();
+  return __real_malloc(size);
+}
+void* __wrap_calloc(size_t count, size_t size) {
+  countHeapCall();
+  return __real_calloc(count, size);
+}
+void* __wrap_realloc(void* pointer, size_t size) {
+  countHeapCall();
+  return __real_realloc(pointer, size);
+}
+}
+
+void* operator new(size_t size) {
+  countHeapCall();
+  void* pointer = __real_malloc(size ? size : 1);
+  if (pointer == nullptr)
+    throw std::bad_alloc();
+  return pointer;
+}
+void operator delete(void* pointer) noexcept {
+  free(pointer);
+}
+void operator delete(void* pointer, size_t) noexcept {
+  free(pointer);
+}
+
+static void onRecord(const MMWaveRecord& record, void* ctx) {
+  *static_cast<uint32_t*>(ctx) += record.words;
+}
+
+int main() {
+  // The counters do see heap calls
+  g_counting            = true;
+  int* volatile integer = new int(0);
+  void* volatile block  = malloc(16);
+  g_counting            = false;
+  delete integer;
+  free(block);
+  CHECK(g_heap_calls == 2);
+  g_heap_calls = 0;
+
+  // Ten seconds of vital signs, targets and point clouds, several people
+  MMWaveEmulatorConfig config;
+  config.max_people = 3;
+  SeeedmmWaveEmulator emulator(config);
+  std::vector<uint8_t> stream;
+  size_t frames = emulator.generate(10000000, stream);
+
+  SeeedmmWaveReplayTransport capture;
+  capture.load(stream.data(), stream.size());
+  std::unique_ptr<SeeedmmWaveT<SEEED_MR60BHA2>> sensor(
+      new SeeedmmWaveT<SEEED_MR60BHA2>());
+  sensor->begin(&capture);
+  sensor->setQueuePolicy(TypeHeartBreath::Report3DPointCloudTargetInfo,
+                         MMWaveQueuePolicy::LatestOnly);
+  uint32_t words = 0;
+  sensor->subscribe(MMWAVE_ANY_TYPE, onRecord, &words);
+
+  // The first pass sets up whatever is set up lazily, the second one is
+  // the steady state
+  for (int pass = 0; pass < 2; pass++) {
+    uint32_t before = sensor->getParserStats().frames;
+    capture.rewind();
+    g_counting = pass == 1;
+    while (!capture.finished()) {
+      sensor->fetch(0);
+      sensor->processQueuedFrames();
+    }
+    g_counting = false;
+    CHECK(sensor->getParserStats().frames - before == frames);
+  }
+
+  CHECK(frames > 0);
+  CHECK(words > 0);
+  if (g_heap_calls)
+    fprintf(stderr, "%u heap calls while receiving\n",
+            unsigned(g_heap_calls.load()));
+  CHECK(g_heap_calls == 0);
+
+  return testResult("test_no_alloc");
+}
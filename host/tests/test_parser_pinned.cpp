@@ -0,0 +1,68 @@
+/**
+ * @file test_parser_pinned.cpp
+ *
+ * @note A frame pinned by front() survives the ring filling up behind it.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "SeeedmmWaveParser.h"
+#include "mmwave_test.h"
+
+static std::vector<uint8_t> payloadOf(SeeedmmWaveParser& parser,
+                                      const MMWaveFrame& frame) {
+  MMWaveFrameView view = parser.payload(frame);
+  std::vector<uint8_t> bytes(view.size());
+  view.copy(bytes.data(), 0, bytes.size());
+  return bytes;
+}
+
+int main() {
+  std::unique_ptr<SeeedmmWaveParser> parser(new SeeedmmWaveParser());
+
+  std::vector<uint8_t> first(12), second(12);
+  for (size_t i = 0; i < first.size(); i++) {
+    first[i]  = uint8_t(0xA0 + i);
+    second[i] = uint8_t(0xB0 + i);
+  }
+  CHECK(feed(*parser, buildFrame(0, 0x0A13, first)) > 0);
+  CHECK(feed(*parser, buildFrame(1, 0x0A13, second)) > 0);
+  CHECK(parser->size() == 2);
+
+  // Pin the oldest frame, as processQueuedFrames() does around handleType()
+  MMWaveFrame pinned          = parser->front();
+  MMWaveFrameView pinned_view = parser->payload(pinned);
+  CHECK(pinned.id == 0);
+  CHECK(payloadOf(*parser, pinned) == first);
+
+  // Keep receiving far more than the ring holds
+  std::vector<uint8_t> filler(100, 0x55);
+  size_t offered = 0, taken = 0;
+  for (uint16_t id = 2; offered < 4 * MMWAVE_RX_RING_SIZE; id++) {
+    std::vector<uint8_t> frame = buildFrame(id, 0x0A15, filler);
+    offered += frame.size();
+    taken += feed(*parser, frame);
+  }
+  CHECK(taken < offered);
+
+  // The pinned frame is still first, its bytes untouched
+  CHECK(parser->front().id == 0);
+  CHECK(parser->front().start == pinned.start);
+  std::vector<uint8_t> still(pinned_view.size());
+  pinned_view.copy(still.data(), 0, still.size());
+  CHECK(still == first);
+  CHECK(parser->parserStats().evicted == 0);
+
+  // Releasing it lets the next frame through and the ring fill again
+  parser->pop();
+  CHECK(!parser->empty());
+  CHECK(parser->front().id == 1);
+  CHECK(payloadOf(*parser, parser->front()) == second);
+  parser->pop();
+  size_t room;
+  parser->writeBuffer(room);
+  CHECK(room > 0);
+
+  return testResult("test_parser_pinned");
+}
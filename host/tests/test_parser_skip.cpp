@@ -0,0 +1,64 @@
+/**
+ * @file test_parser_skip.cpp
+ *
+ * @note A skipped type is stepped over for its length only when that length
+ * is plausible; an impossible one is dropped and the next frame found.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "SeeedmmWaveParser.h"
+#include "mmwave_test.h"
+
+static const uint16_t kAccepted = 0x0A15;
+static const uint16_t kSkipped  = 0x0A13;
+
+int main() {
+  std::unique_ptr<SeeedmmWaveParser> parser(new SeeedmmWaveParser());
+  const uint16_t accepted[] = {kAccepted};
+  CHECK(parser->setAcceptedTypes(accepted, 1));
+
+  // A skipped frame of a real length is stepped over whole
+  std::vector<uint8_t> stream =
+      buildFrame(0, kSkipped, std::vector<uint8_t>(20));
+  std::vector<uint8_t> frame = buildFrame(1, kAccepted, {1, 2, 3, 4});
+  stream.insert(stream.end(), frame.begin(), frame.end());
+
+  // A header of a skipped type whose checksum matches but whose length no
+  // frame can have, followed directly by a good frame
+  std::vector<uint8_t> bogus = buildFrame(2, kSkipped, {});
+  bogus[3]      = 0xEA;  // 60000 bytes
+  bogus[4]      = 0x60;
+  uint8_t cksum = 0;
+  for (size_t i = 0; i < 7; i++) {
+    cksum ^= bogus[i];
+  }
+  bogus[7] = ~cksum;
+  bogus.resize(8);
+  stream.insert(stream.end(), bogus.begin(), bogus.end());
+  frame = buildFrame(3, kAccepted, {5, 6, 7, 8});
+  stream.insert(stream.end(), frame.begin(), frame.end());
+
+  CHECK(feed(*parser, stream) == stream.size());
+
+  CHECK(parser->size() == 2);
+  CHECK(!parser->empty() && parser->front().id == 1);
+  parser->pop();
+  CHECK(!parser->empty() && parser->front().id == 3);
+  parser->pop();
+
+  const MMWaveParserStats& stats = parser->parserStats();
+  CHECK(stats.oversize == 1);
+  CHECK(stats.frames == 2);
+  size_t count;
+  const MMWaveTypeStats* types = parser->typeStats(count);
+  for (size_t i = 0; i < count; i++) {
+    if (types[i].type == kSkipped) {
+      CHECK(types[i].skipped == 1);
+      CHECK(types[i].dropped == 1);
+    }
+  }
+
+  return testResult("test_parser_skip");
+}
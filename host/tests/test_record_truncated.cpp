@@ -0,0 +1,71 @@
+/**
+ * @file test_record_truncated.cpp
+ *
+ * @note Records of payloads longer than their words are flagged truncated.
+ */
+
+#include <vector>
+
+#include "SeeedmmWaveReplay.h"
+#include "Seeed_Arduino_mmWave.h"
+#include "mmwave_test.h"
+
+static void keep(const MMWaveRecord& record, void* ctx) {
+  static_cast<std::vector<MMWaveRecord>*>(ctx)->push_back(record);
+}
+
+static void append(std::vector<uint8_t>& stream, uint16_t id,
+                   TypeHeartBreath type, const std::vector<uint8_t>& payload) {
+  std::vector<uint8_t> frame =
+      buildFrame(id, static_cast<uint16_t>(type), payload);
+  stream.insert(stream.end(), frame.begin(), frame.end());
+}
+
+int main() {
+  std::vector<uint8_t> stream;
+
+  // Target list of three targets, 13 words
+  const uint32_t kTargets = 3;
+  std::vector<uint8_t> targets(sizeof(uint32_t) +
+                               kTargets * MMWAVE_POINT_SIZE);
+  MMWaveWire<uint32_t>::encode(kTargets, targets.data());
+  for (uint32_t i = 0; i < kTargets; i++) {
+    uint8_t* point = targets.data() + sizeof(uint32_t) + i * MMWAVE_POINT_SIZE;
+    MMWaveWire<float>::encode(0.5f * i, point);
+    MMWaveWire<float>::encode(1.0f, point + 4);
+  }
+  append(stream, 0, TypeHeartBreath::Report3DPointCloudTargetInfo, targets);
+
+  // Heart rate, one word
+  std::vector<uint8_t> rate(sizeof(float));
+  MMWaveFloatPayload::encode(rate.data(), 72.0f);
+  append(stream, 1, TypeHeartBreath::TypeHeartRate, rate);
+
+  SeeedmmWaveReplayTransport capture;
+  capture.load(stream.data(), stream.size());
+  SeeedmmWaveT<SEEED_MR60BHA2> sensor;
+  sensor.begin(&capture);
+  std::vector<MMWaveRecord> records;
+  sensor.subscribe(MMWAVE_ANY_TYPE, keep, &records);
+  while (!capture.finished()) {
+    sensor.fetch(0);
+    sensor.processQueuedFrames();
+  }
+
+  CHECK(records.size() == 2);
+  if (records.size() == 2) {
+    CHECK(records[0].data_len == targets.size());
+    CHECK(records[0].words == MMWAVE_RECORD_WORDS);
+    CHECK(records[0].value[0].u == kTargets);
+    CHECK(records[0].truncated);
+    CHECK(records[1].words == 1);
+    CHECK(records[1].value[0].f == 72.0f);
+    CHECK(!records[1].truncated);
+  }
+
+  // The getter still has every target
+  MMWavePointCloud cloud;
+  CHECK(sensor.getTargetInfo(cloud) && cloud.count == kTargets);
+
+  return testResult("test_record_truncated");
+}
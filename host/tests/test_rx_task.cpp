@@ -0,0 +1,49 @@
+/**
+ * @file test_rx_task.cpp
+ *
+ * @note The RX task publishes a record for every frame, from the first one,
+ * however soon it runs after startRxTask().
+ */
+
+#include <vector>
+
+#include "SeeedmmWaveReplay.h"
+#include "Seeed_Arduino_mmWave.h"
+#include "mmwave_test.h"
+
+int main() {
+  const uint16_t kFrames = 20;
+  std::vector<uint8_t> stream;
+  for (uint16_t id = 0; id < kFrames; id++) {
+    std::vector<uint8_t> payload(sizeof(float));
+    MMWaveFloatPayload::encode(payload.data(), 60.0f + id);
+    std::vector<uint8_t> frame = buildFrame(
+        id, static_cast<uint16_t>(TypeHeartBreath::TypeHeartRate), payload);
+    stream.insert(stream.end(), frame.begin(), frame.end());
+  }
+  // Waiting to be read before the task starts
+  SeeedmmWaveReplayTransport capture;
+  capture.load(stream.data(), stream.size());
+
+  SeeedmmWaveT<SEEED_MR60BHA2> sensor;
+  sensor.begin(&capture);
+  CHECK(sensor.startRxTask());
+  CHECK(sensor.isRxTaskRunning());
+
+  MMWaveRecord record;
+  uint16_t count = 0;
+  while (count < kFrames && sensor.readRecord(record, 500)) {
+    CHECK(record.id == count);
+    CHECK(record.value[0].f == 60.0f + count);
+    count++;
+  }
+  CHECK(count == kFrames);
+  CHECK(sensor.getRecordsDropped() == 0);
+
+  // Other tasks keep off the receive path while the task runs
+  CHECK(!sensor.update(0));
+  sensor.stopRxTask();
+  CHECK(!sensor.isRxTaskRunning());
+
+  return testResult("test_rx_task");
+}
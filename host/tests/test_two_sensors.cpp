@@ -0,0 +1,97 @@
+/**
+ * @file test_two_sensors.cpp
+ *
+ * @note Two sensors read in turn keep their frames, IDs and values apart.
+ */
+
+#include <vector>
+
+#include "SeeedmmWaveReplay.h"
+#include "Seeed_Arduino_mmWave.h"
+#include "mmwave_test.h"
+
+// Heart rate reports with consecutive IDs and a rate of their own
+static std::vector<uint8_t> heartRates(uint16_t first_id, size_t count,
+                                       float rate) {
+  std::vector<uint8_t> stream;
+  for (size_t i = 0; i < count; i++) {
+    std::vector<uint8_t> payload(sizeof(float));
+    MMWaveFloatPayload::encode(payload.data(), rate);
+    std::vector<uint8_t> frame = buildFrame(
+        uint16_t(first_id + i),
+        static_cast<uint16_t>(TypeHeartBreath::TypeHeartRate),
+        payload);
+    stream.insert(stream.end(), frame.begin(), frame.end());
+  }
+  return stream;
+}
+
+static void recordId(const MMWaveRecord& record, void* ctx) {
+  static_cast<std::vector<uint16_t>*>(ctx)->push_back(record.id);
+}
+
+int main() {
+  const size_t kFrames = 40;
+  std::vector<uint8_t> stream_a = heartRates(0x0100, kFrames, 60);
+  std::vector<uint8_t> stream_b = heartRates(0x8000, kFrames, 95);
+
+  // Pieces of a few bytes, so that both parsers hold a partial frame
+  // whenever the other one runs
+  SeeedmmWaveReplayTransport capture_a, capture_b;
+  capture_a.load(stream_a.data(), stream_a.size());
+  capture_b.load(stream_b.data(), stream_b.size());
+  capture_a.setReadChunk(5);
+  capture_b.setReadChunk(7);
+
+  SeeedmmWaveT<SEEED_MR60BHA2> sensor_a, sensor_b;
+  sensor_a.begin(&capture_a);
+  // A link without a baud rate, frames are then not back-dated
+  sensor_b.begin(&capture_b, 0);
+  std::vector<uint16_t> ids_a, ids_b;
+  sensor_a.subscribe(TypeHeartBreath::TypeHeartRate, recordId, &ids_a);
+  sensor_b.subscribe(TypeHeartBreath::TypeHeartRate, recordId, &ids_b);
+
+  while (!capture_a.finished() || !capture_b.finished()) {
+    sensor_a.fetch(0);
+    sensor_a.processQueuedFrames();
+    sensor_b.fetch(0);
+    sensor_b.processQueuedFrames();
+  }
+
+  CHECK(sensor_a.getParserStats().frames == kFrames);
+  CHECK(sensor_b.getParserStats().frames == kFrames);
+  CHECK(sensor_a.getParserStats().bytes == stream_a.size());
+  CHECK(sensor_b.getParserStats().bytes == stream_b.size());
+  CHECK(sensor_a.getParserStats().header_errors == 0);
+  CHECK(sensor_b.getParserStats().header_errors == 0);
+  CHECK(sensor_a.getParserStats().id_gaps == 0);
+  CHECK(sensor_b.getParserStats().id_gaps == 0);
+
+  CHECK(ids_a.size() == kFrames);
+  CHECK(ids_b.size() == kFrames);
+  for (size_t i = 0; i < ids_a.size(); i++) {
+    CHECK(ids_a[i] == 0x0100 + i);
+  }
+  for (size_t i = 0; i < ids_b.size(); i++) {
+    CHECK(ids_b[i] == 0x8000 + i);
+  }
+
+  // Every heart rate reached the sensor it was sent to, and only that one
+  RateSample rates[MR60BHA2_RATE_HISTORY_SIZE];
+  size_t count;
+  while ((count = sensor_a.drainHeartRates(rates)) != 0) {
+    for (size_t i = 0; i < count; i++) {
+      CHECK(rates[i].rate == 60);
+    }
+  }
+  while ((count = sensor_b.drainHeartRates(rates)) != 0) {
+    for (size_t i = 0; i < count; i++) {
+      CHECK(rates[i].rate == 95);
+    }
+  }
+  MR60BHA2Vitals vitals_a, vitals_b;
+  CHECK(sensor_a.getVitals(vitals_a) && vitals_a.heart_rate == 60);
+  CHECK(sensor_b.getVitals(vitals_b) && vitals_b.heart_rate == 95);
+
+  return testResult("test_two_sensors");
+}
@@ -9,6 +9,12 @@
 #include "Arduino.h"
 #include "Seeed_Arduino_mmWave.h"
 #include "led_strip.h"
+#if CONFIG_HEAP_TRACING_STANDALONE
+  #include "esp_heap_trace.h"
+#endif
+#if MMWAVE_DIAG_METRICS
+  #include "esp_diagnostics_metrics.h"
+#endif
 
 static const char *TAG = "mmWave_feature";
 static const char *TAG_1 = "LED";
@@ -113,7 +119,27 @@ bool isSignalValid(float currentPhase) {
 
 // ---------------------------- 
 
-SEEED_MR60BHA2 mmWave;
+// Frames are decoded by a direct, inlined call into the MR60BHA2 decoder
+SeeedmmWaveT<SEEED_MR60BHA2> mmWave;
+
+#if CONFIG_HEAP_TRACING_STANDALONE
+// Frame reception is allocation free: trace the heap while this task alone
+// receives, before the RX task and the LED start (see also the host test
+// host/tests/test_no_alloc.cpp)
+#define HEAP_TRACE_RECORDS 32
+#define HEAP_TRACE_FETCHES 20
+static heap_trace_record_t heap_trace_records[HEAP_TRACE_RECORDS];
+#endif
+
+#if MMWAVE_DIAG_METRICS && !CONFIG_ESP_INSIGHTS_ENABLED
+// Without esp_insights to upload them, the metrics are only logged
+static esp_err_t log_metric(const char *tag, void *data, size_t len, void *cb_arg)
+{
+    const esp_diag_data_pt_t *point = (const esp_diag_data_pt_t *)data;
+    ESP_LOGD(TAG, "metric %s: %lu", point->key, (unsigned long)point->value.u);
+    return ESP_OK;
+}
+#endif
 
 extern "C" void app_main(void)
 {
@@ -133,6 +159,64 @@ extern "C" void app_main(void)
 
     // Initialize the mmWave sensor
     mmWave.begin(&mmWaveSerial);
+    // Point clouds and distance are not used: skip them unread
+    mmWave.setAcceptedTypes({TypeHeartBreath::Report3DPointCloudTargetInfo,
+                             TypeHeartBreath::TypeHeartBreathPhase,
+                             TypeHeartBreath::TypeBreathRate,
+                             TypeHeartBreath::TypeHeartRate,
+                             TypeHeartBreath::ReportHumanDetection});
+    // Only the newest target list matters; vital signs are evicted last
+    mmWave.setQueuePolicy(TypeHeartBreath::Report3DPointCloudTargetInfo,
+                          MMWaveQueuePolicy::LatestOnly);
+    mmWave.setQueuePolicy(TypeHeartBreath::TypeHeartBreathPhase,
+                          MMWaveQueuePolicy::KeepAll, 2);
+    mmWave.setQueuePolicy(TypeHeartBreath::TypeHeartRate,
+                          MMWaveQueuePolicy::KeepAll, 2);
+    mmWave.setQueuePolicy(TypeHeartBreath::TypeBreathRate,
+                          MMWaveQueuePolicy::KeepAll, 2);
+    mmWave.setQueuePolicy(TypeHeartBreath::ReportHumanDetection,
+                          MMWaveQueuePolicy::LatestOnly, 1);
+#if MMWAVE_DIAG_METRICS
+#if !CONFIG_ESP_INSIGHTS_ENABLED
+    esp_diag_metrics_config_t metrics_config = {log_metric, nullptr};
+    esp_diag_metrics_init(&metrics_config);
+#endif
+    // Published below, so that data loss on deployed devices shows up
+    if (!mmWave.registerMetrics("mmw")) {
+        ESP_LOGW(TAG, "mmWave metrics not registered");
+    }
+#endif
+#if CONFIG_HEAP_TRACING_STANDALONE
+    // One fetch() first so that the trace covers the steady state only.
+    // HEAP_TRACE_ALL records every task, hence a window in which no other
+    // task of the application runs yet; the records name the callers.
+    mmWave.fetch(100);
+    mmWave.processQueuedFrames();
+    ESP_ERROR_CHECK(heap_trace_init_standalone(heap_trace_records, HEAP_TRACE_RECORDS));
+    ESP_ERROR_CHECK(heap_trace_start(HEAP_TRACE_ALL));
+    for (int i = 0; i < HEAP_TRACE_FETCHES; i++) {
+        mmWave.fetch(100);
+        mmWave.processQueuedFrames();
+    }
+    ESP_ERROR_CHECK(heap_trace_stop());
+    heap_trace_summary_t heap_summary;
+    if (heap_trace_summary(&heap_summary) == ESP_OK) {
+        ESP_LOGI(TAG, "mmWave reception: %lu heap allocations, %lu frees over %lu frames",
+                 (unsigned long)heap_summary.total_allocations,
+                 (unsigned long)heap_summary.total_frees,
+                 (unsigned long)mmWave.getParserStats().frames);
+        if (heap_summary.total_allocations) {
+            heap_trace_dump();
+        }
+    }
+#endif
+
+    // Receive in a dedicated task woken by UART RX events: frames are parsed
+    // as they arrive, whatever this loop is doing, so their timestamps and
+    // the interval and jitter statistics are those of the sensor
+    if (!mmWave.startRxTask()) {
+        ESP_LOGE(TAG, "mmWave RX task not started");
+    }
     ESP_LOGI(TAG, "mmWave sensor initialized");
     
     // Initialize Serial for logging
@@ -143,9 +227,66 @@ extern "C" void app_main(void)
 
     ESP_LOGI(TAG_1, "Start blinking LED strip");
 
+    uint32_t loop_count  = 0;
+    uint32_t vitals_seen = 0;
+
     // Main loop
     while (1) {
 
+        // Report how much CPU time fetch() burns for the frames it delivers
+        if (++loop_count % 100 == 0) {
+            const FetchStats& stats = mmWave.getFetchStats(mmWave.getFetchMode());
+            ESP_LOGI(TAG, "fetch: %lu calls, %lu frames, busy %llu us of %llu us",
+                     (unsigned long)stats.calls, (unsigned long)stats.frames,
+                     (unsigned long long)stats.busy_us,
+                     (unsigned long long)stats.wall_us);
+            if (stats.frames && stats.dispatched) {
+                ESP_LOGI(TAG, "cycles/frame: %llu framing, %llu dispatch",
+                         (unsigned long long)(stats.parse_cycles / stats.frames),
+                         (unsigned long long)(stats.dispatch_cycles / stats.dispatched));
+            }
+            const MMWaveParserStats& parser = mmWave.getParserStats();
+            ESP_LOGI(TAG, "stream: %llu bytes, %lu header / %lu data checksum errors, "
+                     "%lu oversize, %lu evicted, %lu overflowed, %lu ID gaps",
+                     (unsigned long long)parser.bytes,
+                     (unsigned long)parser.header_errors,
+                     (unsigned long)parser.data_errors,
+                     (unsigned long)parser.oversize,
+                     (unsigned long)parser.evicted,
+                     (unsigned long)parser.overflowed,
+                     (unsigned long)parser.id_gaps);
+#if MMWAVE_DIAG_METRICS
+            mmWave.reportMetrics();
+#endif
+            // Non-destructive: other tasks may read the same snapshot
+            MR60BHA2Vitals vitals;
+            if (mmWave.getVitals(vitals)) {
+                ESP_LOGI(TAG, "vitals #%lu: HR %.1f, BR %.1f, %s, %lu targets",
+                         (unsigned long)vitals.updates, vitals.heart_rate,
+                         vitals.breath_rate,
+                         vitals.human_present ? "present" : "absent",
+                         (unsigned long)vitals.target_count);
+            }
+            size_t type_count;
+            const MMWaveTypeStats* type_stats = mmWave.getTypeStats(type_count);
+            for (size_t i = 0; i < type_count; i++) {
+                ESP_LOGI(TAG, "type 0x%04X: %lu accepted, %lu truncated, %lu dropped, %lu skipped",
+                         type_stats[i].type, (unsigned long)type_stats[i].accepted,
+                         (unsigned long)type_stats[i].truncated,
+                         (unsigned long)type_stats[i].dropped,
+                         (unsigned long)type_stats[i].skipped);
+                if (type_stats[i].intervals) {
+                    double n      = type_stats[i].intervals;
+                    double mean   = type_stats[i].interval_sum_us / n;
+                    double var    = type_stats[i].interval_sq_sum_us / n - mean * mean;
+                    ESP_LOGI(TAG, "type 0x%04X: interval mean %.0f us, jitter %.0f us, min %lu us, max %lu us",
+                             type_stats[i].type, mean, var > 0 ? sqrt(var) : 0.0,
+                             (unsigned long)type_stats[i].interval_min_us,
+                             (unsigned long)type_stats[i].interval_max_us);
+                }
+            }
+        }
+
         // LED function
         if (led_on_off) {
             /* Set the LED pixel using RGB from 0 (0%) to 255 (100%) for each color */
@@ -164,44 +305,34 @@ extern "C" void app_main(void)
             vTaskDelay(pdMS_TO_TICKS(500));
         
 
-        // mmWave function
-        if (mmWave.update(100)) {
-            float total_phase, breath_phase, heart_phase;
-            if (mmWave.isHumanDetected()) {
-                // ESP_LOGI(TAG, "----- Human Detected-----");
-            }
-
-            PeopleCounting target_info;
-            if (mmWave.getPeopleCountingTargetInfo(target_info)) {
-                // ESP_LOGI(TAG, "-----Got Target Info-----");
-                // ESP_LOGI(TAG, "Number of targets: %zu", target_info.targets.size());
+        // mmWave function: the RX task has received and decoded everything
+        // in the background, the loop only reads what it published
+        vTaskDelay(pdMS_TO_TICKS(100));
+        MR60BHA2Vitals vitals;
+        if (mmWave.getVitals(vitals) && vitals.updates != vitals_seen) {
+            vitals_seen = vitals.updates;
+            // Every sample received since the last loop, kept by the RX task
+            static PhaseSample phases[MR60BHA2_PHASE_HISTORY_SIZE];
+            static RateSample heart_rates[MR60BHA2_RATE_HISTORY_SIZE];
+            size_t phase_count = mmWave.drainHeartBreathPhases(phases);
+            size_t rate_count  = mmWave.drainHeartRates(heart_rates);
+
+            if (vitals.target_count) {
+                // ESP_LOGI(TAG, "Number of targets: %lu", (unsigned long)vitals.target_count);
 
                 // heart_rate sensor
-                if (mmWave.getHeartBreathPhases(total_phase, breath_phase, heart_phase)) {
-                    if (isSignalValid(heart_phase)) {
-                        float heart_rate;
-                        if (mmWave.getHeartRate(heart_rate)) {
-                            float filteredHR = getFilteredHeartRate(heart_rate);
-
-                            // Print LED status instead of controlling NeoPixel
-                            // ESP_LOGI(TAG, "Heart rate detected - GREEN LED would light up");
-                            
-                            if (filteredHR > 0) {
-                                // Serial.printf("HR_Filtered: %.2f\n", filteredHR);
-                                ESP_LOGI(TAG, "HR_Filtered: %.2f", filteredHR);
-                            }
-                        }
+                if (phase_count && isSignalValid(phases[phase_count - 1].heart_phase)) {
+                    for (size_t i = 0; i < rate_count; i++) {
+                        float filteredHR = getFilteredHeartRate(heart_rates[i].rate);
 
-                        // Serial.printf("heart_phase_____: %.2f\n", heart_phase);
-                        // printf("heart_phase_____: %.2f\n", heart_phase);
-                    }
-                }
+                        // Print LED status instead of controlling NeoPixel
+                        // ESP_LOGI(TAG, "Heart rate detected - GREEN LED would light up");
 
-                for (size_t i = 0; i < target_info.targets.size(); i++) {
-                    const auto& target = target_info.targets[i];
-                    // Serial.printf("Total Target: %zu\n", i + 1);
-                    // Serial.printf("  move_speed: %.2f cm/s\n", target.dop_index * RANGE_STEP);
-                    // ("Total Target: %zu, move_speed: %.2f cm/s\n", i + 1, target.dop_index * 0.5);
+                        if (filteredHR > 0) {
+                            // Serial.printf("HR_Filtered: %.2f\n", filteredHR);
+                            ESP_LOGI(TAG, "HR_Filtered: %.2f", filteredHR);
+                        }
+                    }
                 }
             } else {
                 // Print LED status instead of fading NeoPixel
@@ -216,7 +347,5 @@ extern "C" void app_main(void)
                 printf("----- no one detected ----\n");
             }
         }
-        
-        vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
\ No newline at end of file
@@ -1,126 +1,112 @@
 #include "SEEED_MR60BHA2.h"
 
-/**
- * @brief Handle different types of heart and breath data.
- *
- * This function processes different types of heart and breath data based on
- * the type identifier. It first deletes any existing objects to avoid memory
- * leaks.
- *
- * @param _type The type identifier of the data.
- * @param data The pointer to the data buffer.
- * @param data_len The length of the data buffer.
- * @return true if the data is handled successfully.
- * @return false if there is an error in handling the data.
- */
 bool SEEED_MR60BHA2::handleType(uint16_t _type, const uint8_t* data,
                                 size_t data_len) {
-  TypeHeartBreath type = static_cast<TypeHeartBreath>(_type);
-  switch (type) {
-    case TypeHeartBreath::TypeHeartBreathPhase: {
-      _heart_breath.total_phase  = extractFloat(data);
-      _heart_breath.breath_phase = extractFloat(data + sizeof(float));
-      _heart_breath.heart_phase  = extractFloat(data + 2 * sizeof(float));
-      _isHeartBreathPhaseValid   = true;
-      break;
-    }
-    case TypeHeartBreath::TypeBreathRate: {
-      _breath_rate       = extractFloat(data);
-      _isBreathRateValid = true;
-      break;
-    }
-    case TypeHeartBreath::TypeHeartRate: {
-      _heart_rate       = extractFloat(data);
-      _isHeartRateValid = true;
-      break;
-    }
-    case TypeHeartBreath::TypeHeartBreathDistance: {
-      _rangeFlag       = extractU32(data);
-      _range           = extractFloat(data + sizeof(uint32_t));
-      _isDistanceValid = true;
-      break;
-    }
-    case TypeHeartBreath::ReportHumanDetection: {
-      _isHumanDetected = data[0];
-      _isHumanDetectionValid = true;
-      break;
-    }
-    case TypeHeartBreath::Report3DPointCloudDetection: {
-      size_t target_num = extractU32(data);  // Extract target quantity
-      data += sizeof(uint32_t);
-
-      std::vector<TargetN> received_targets; // Used to store parsed target data
-      received_targets.reserve(target_num);
-
-      for(size_t i = 0; i < target_num; i++)
-      {
-        TargetN target;
-        target.x_point = extractFloat(data);
-        data += sizeof(float);
-
-        target.y_point = extractFloat(data);
-        data += sizeof(float);
-
-        target.dop_index = extractU32(data);
-        data += sizeof(int32_t);
-
-        target.cluster_index = extractU32(data);
-        data += sizeof(int32_t);
-
-        received_targets.push_back(target); // Add the resolved target to the container
-      }
-
-      // Store the received target data in the PeopleCounting object
-      _people_counting_point_cloud.targets = std::move(received_targets);
-      _isPeopleCountingPointCloudValid = true;
-
-      break;
-    }
-    case TypeHeartBreath::Report3DPointCloudTargetInfo: {
-      size_t target_num = extractU32(data);  // Extract target quantity
-      data += sizeof(uint32_t);
-
-      std::vector<TargetN> received_targets; // Used to store parsed target data
-      received_targets.reserve(target_num);
-
-      for(size_t i = 0; i < target_num; i++)
-      {
-        TargetN target;
-        target.x_point = extractFloat(data);
-        data += sizeof(float);
-
-        target.y_point = extractFloat(data);
-        data += sizeof(float);
-
-        target.dop_index = extractU32(data);
-        data += sizeof(int32_t);
-
-        target.cluster_index = extractU32(data);
-        data += sizeof(int32_t);
-
-        received_targets.push_back(target); // Add the resolved target to the container
-      }
-
-      // Store the received target data in the PeopleCounting object
-      _people_counting_target_info.targets = std::move(received_targets);
-      _isPeopleCountingTargetInfoValid = true;
-
-      break;
-    }
-    case TypeHeartBreath::ReportFirmware: {
-      _firmware_info.value = extractU32(data);
-      _isFirmwareInfoValid = true;
-      break;
-    }
-    default:
-      return false;  // Unhandled type
+  return handleType(_type, MMWaveFrameView(data, data_len));
+}
+
+void SEEED_MR60BHA2::onHeartBreathPhase(const HeartBreath& phases) {
+  _heart_breath            = phases;
+  _heart_breath_time       = frameTimestamp();
+  _isHeartBreathPhaseValid = true;
+  _phase_history.push({_heart_breath_time, phases.total_phase,
+                       phases.breath_phase, phases.heart_phase});
+  _vitals_draft.phases    = phases;
+  _vitals_draft.phases_us = _heart_breath_time;
+  publishVitals();
+}
+
+void SEEED_MR60BHA2::onBreathRate(const float& rate) {
+  _breath_rate       = rate;
+  _breath_rate_time  = frameTimestamp();
+  _isBreathRateValid = true;
+  _breath_rate_history.push({_breath_rate_time, rate});
+  _vitals_draft.breath_rate    = rate;
+  _vitals_draft.breath_rate_us = _breath_rate_time;
+  publishVitals();
+}
+
+void SEEED_MR60BHA2::onHeartRate(const float& rate) {
+  _heart_rate       = rate;
+  _heart_rate_time  = frameTimestamp();
+  _isHeartRateValid = true;
+  _heart_rate_history.push({_heart_rate_time, rate});
+  _vitals_draft.heart_rate    = rate;
+  _vitals_draft.heart_rate_us = _heart_rate_time;
+  publishVitals();
+}
+
+void SEEED_MR60BHA2::onDistance(const RangeReport& range) {
+  _rangeFlag       = range.flag;
+  _range           = range.range;
+  _range_time      = frameTimestamp();
+  _isDistanceValid = true;
+  // Same rule as getDistance(): no distance without the range flag
+  if (_rangeFlag)
+    _distance_history.push({_range_time, _range});
+  _vitals_draft.distance       = _range;
+  _vitals_draft.distance_valid = _rangeFlag;
+  _vitals_draft.distance_us    = _range_time;
+  publishVitals();
+}
+
+void SEEED_MR60BHA2::onHumanDetection(const uint8_t& detected) {
+  _isHumanDetected       = detected;
+  _isHumanDetectionValid = true;
+  _vitals_draft.human_present = detected;
+  _vitals_draft.presence_us   = frameTimestamp();
+  publishVitals();
+}
+
+void SEEED_MR60BHA2::onPointCloud(const MMWaveFrameView& data) {
+  _isPeopleCountingPointCloudValid = decodePointCloud(data, _point_cloud);
+}
+
+void SEEED_MR60BHA2::onTargetInfo(const MMWaveFrameView& data) {
+  _isPeopleCountingTargetInfoValid = decodePointCloud(data, _target_info);
+  if (_isPeopleCountingTargetInfoValid) {
+    _vitals_draft.target_count = _target_info.count;
+    _vitals_draft.targets_us   = _target_info.timestamp_us;
+    publishVitals();
   }
-  return true;
+}
+
+/**
+ * @brief Publish the draft snapshot. Only the task handling the frames
+ * writes it, so the draft itself needs no protection.
+ */
+void SEEED_MR60BHA2::publishVitals() {
+  _vitals_draft.updates++;
+  _vitals.write(_vitals_draft);
+}
+
+bool SEEED_MR60BHA2::getVitals(MR60BHA2Vitals& vitals) const {
+  // A reader preempting the writer mid-update would spin until the writer
+  // runs again: after a few tries, sleep a tick to let it finish
+  for (uint32_t tries = 1; !_vitals.tryRead(vitals); tries++) {
+    if (tries >= 3)
+      vTaskDelay(1);
+  }
+  return vitals.updates != 0;
+}
+
+void SEEED_MR60BHA2::onFirmware(const uint32_t& value) {
+  _firmware_info.value = value;
+  _isFirmwareInfoValid = true;
 }
 
 bool SEEED_MR60BHA2::getHeartBreathPhases(float& total_phase,
                                           float& breath_phase,
                                           float& heart_phase) {
+  int64_t timestamp_us;
+  return getHeartBreathPhases(total_phase, breath_phase, heart_phase,
+                              timestamp_us);
+}
+
+bool SEEED_MR60BHA2::getHeartBreathPhases(float& total_phase,
+                                          float& breath_phase,
+                                          float& heart_phase,
+                                          int64_t& timestamp_us) {
   if (!_isHeartBreathPhaseValid)
     return false;
   _isHeartBreathPhaseValid = false;
@@ -128,38 +114,85 @@ bool SEEED_MR60BHA2::getHeartBreathPhases(float& total_phase,
   total_phase  = _heart_breath.total_phase;
   breath_phase = _heart_breath.breath_phase;
   heart_phase  = _heart_breath.heart_phase;
+  timestamp_us = _heart_breath_time;
   return true;
 }
 
 bool SEEED_MR60BHA2::getBreathRate(float& rate) {
+  int64_t timestamp_us;
+  return getBreathRate(rate, timestamp_us);
+}
+
+bool SEEED_MR60BHA2::getBreathRate(float& rate, int64_t& timestamp_us) {
   if (!_isBreathRateValid)
     return false;
   _isBreathRateValid = false;
   rate               = _breath_rate;
+  timestamp_us       = _breath_rate_time;
   return true;
 }
 
 bool SEEED_MR60BHA2::getHeartRate(float& rate) {
+  int64_t timestamp_us;
+  return getHeartRate(rate, timestamp_us);
+}
+
+bool SEEED_MR60BHA2::getHeartRate(float& rate, int64_t& timestamp_us) {
   if (!_isHeartRateValid)
     return false;
   _isHeartRateValid = false;
   rate              = _heart_rate;
+  timestamp_us      = _heart_rate_time;
   return true;
 }
 
 bool SEEED_MR60BHA2::getDistance(float& distance) {
+  int64_t timestamp_us;
+  return getDistance(distance, timestamp_us);
+}
+
+bool SEEED_MR60BHA2::getDistance(float& distance, int64_t& timestamp_us) {
   if (!_isDistanceValid || !_rangeFlag)
     return false;
   _isDistanceValid = false;
   distance         = _range;
+  timestamp_us     = _range_time;
   return true;
 }
 
+bool SEEED_MR60BHA2::getPointCloud(MMWavePointCloud& point_cloud) {
+  if (!_isPeopleCountingPointCloudValid)
+    return false;
+  _isPeopleCountingPointCloudValid = false;
+  point_cloud                      = _point_cloud;
+  return true;
+}
+
+bool SEEED_MR60BHA2::getTargetInfo(MMWavePointCloud& target_info) {
+  if (!_isPeopleCountingTargetInfoValid)
+    return false;
+  _isPeopleCountingTargetInfoValid = false;
+  target_info                      = _target_info;
+  return true;
+}
+
+static void toPeopleCounting(const MMWavePointCloud& cloud,
+                             PeopleCounting& people) {
+  people.targets.resize(cloud.count);
+  for (size_t i = 0; i < cloud.count; i++) {
+    people.targets[i].x_point       = cloud.x[i];
+    people.targets[i].y_point       = cloud.y[i];
+    people.targets[i].dop_index     = cloud.dop[i];
+    people.targets[i].cluster_index = cloud.cluster[i];
+  }
+  people.timestamp_us = cloud.timestamp_us;
+}
+
 bool SEEED_MR60BHA2::getPeopleCountingPointCloud(PeopleCounting& point_cloud) {
   if (!_isPeopleCountingPointCloudValid)
     return false;
   _isPeopleCountingPointCloudValid = false;
-  point_cloud = std::move(_people_counting_point_cloud);
+  toPeopleCounting(_point_cloud, point_cloud);
   return true;
 }
 
@@ -167,7 +200,7 @@ bool SEEED_MR60BHA2::getPeopleCountingTargetInfo(PeopleCounting& target_info) {
   if (!_isPeopleCountingTargetInfoValid)
     return false;
   _isPeopleCountingTargetInfoValid = false;
-  target_info = std::move(_people_counting_target_info);
+  toPeopleCounting(_target_info, target_info);
   return true;
 }
 
@@ -14,20 +14,45 @@
 #define SEEED_MR60BHA2_H
 
 #include "SeeedmmWave.h"
+#include "SeeedmmWaveSeqLock.h"
+#include "SeeedmmWaveFrameTable.h"
 
 #define MAX_TARGET_NUM    3
 
 #define RANGE_STEP 17.28f
 
+// Samples kept per signal until drained, must be powers of two
+#ifndef MR60BHA2_PHASE_HISTORY_SIZE
+#  define MR60BHA2_PHASE_HISTORY_SIZE 64
+#endif
+#ifndef MR60BHA2_RATE_HISTORY_SIZE
+#  define MR60BHA2_RATE_HISTORY_SIZE 16
+#endif
+#ifndef MR60BHA2_DISTANCE_HISTORY_SIZE
+#  define MR60BHA2_DISTANCE_HISTORY_SIZE 16
+#endif
+
+// clang-format off
+/**
+ * @brief Every frame type of the MR60BHA2, the single place to add one.
+ *
+ * X(name, type ID, payload layout, member receiving the decoded payload)
+ */
+#define MR60BHA2_FRAME_TABLE(X)                                                                         \
+  X(Report3DPointCloudTargetInfo, 0x0A04, MMWavePointCloudPayload, &SEEED_MR60BHA2::onTargetInfo)       \
+  X(Report3DPointCloudDetection,  0x0A08, MMWavePointCloudPayload, &SEEED_MR60BHA2::onPointCloud)       \
+  X(TypeHeartBreathPhase,         0x0A13, HeartBreathPayload,      &SEEED_MR60BHA2::onHeartBreathPhase) \
+  X(TypeBreathRate,               0x0A14, MMWaveFloatPayload,      &SEEED_MR60BHA2::onBreathRate)       \
+  X(TypeHeartRate,                0x0A15, MMWaveFloatPayload,      &SEEED_MR60BHA2::onHeartRate)        \
+  X(TypeHeartBreathDistance,      0x0A16, RangePayload,            &SEEED_MR60BHA2::onDistance)         \
+  X(ReportHumanDetection,         0x0F09, MMWaveFlagPayload,       &SEEED_MR60BHA2::onHumanDetection)   \
+  X(ReportFirmware,               0xFFFF, MMWaveU32Payload,        &SEEED_MR60BHA2::onFirmware)
+// clang-format on
+
 enum class TypeHeartBreath : uint16_t {
-  TypeHeartBreathPhase    = 0x0A13,
-  TypeBreathRate          = 0x0A14,
-  TypeHeartRate           = 0x0A15,
-  TypeHeartBreathDistance = 0x0A16,
-  Report3DPointCloudDetection   = 0x0A08,
-  Report3DPointCloudTargetInfo = 0x0A04,
-  ReportHumanDetection       = 0x0F09,
-  ReportFirmware          = 0xFFFF,
+#define X(name, type, payload, handler) MMWAVE_ENUM_VALUE(name, type)
+  MR60BHA2_FRAME_TABLE(X)
+#undef X
 };
 
 typedef struct HeartBreath {
@@ -36,6 +61,55 @@ typedef struct HeartBreath {
   float heart_phase;
 } HeartBreath;
 
+typedef struct PhaseSample {
+  int64_t timestamp_us;
+  float total_phase;
+  float breath_phase;
+  float heart_phase;
+} PhaseSample;
+
+typedef struct RateSample {
+  int64_t timestamp_us;
+  float rate;
+} RateSample;
+
+typedef struct DistanceSample {
+  int64_t timestamp_us;
+  float distance;
+} DistanceSample;
+
+typedef struct RangeReport {
+  uint32_t flag;
+  float range;
+} RangeReport;
+
+// Wire layouts of the reports not shared with other devices
+typedef MMWavePayload<HeartBreath, float, float, float> HeartBreathPayload;
+typedef MMWavePayload<RangeReport, uint32_t, float> RangePayload;
+
+/**
+ * @brief Latest value of every vital sign, published as one snapshot.
+ *
+ * A timestamp is the esp_timer time the frame carrying the value was
+ * received, 0 until the first such frame.
+ */
+typedef struct MR60BHA2Vitals {
+  int64_t phases_us;
+  int64_t breath_rate_us;
+  int64_t heart_rate_us;
+  int64_t distance_us;
+  int64_t presence_us;
+  int64_t targets_us;
+  HeartBreath phases;
+  float breath_rate;
+  float heart_rate;
+  float distance;
+  uint32_t target_count;
+  uint32_t updates;     // snapshots published so far
+  bool distance_valid;  // range flag of the latest distance report
+  bool human_present;
+} MR60BHA2Vitals;
+
 typedef struct TargetN {
   float x_point;
   float y_point;
@@ -57,35 +131,54 @@ typedef union FirmwareInfo {
 
 typedef struct PeopleCounting {
   std::vector<TargetN> targets;
+  int64_t timestamp_us;  // esp_timer time the frame was received
 } PeopleCounting;
 
 class SEEED_MR60BHA2 : public SeeedmmWave {
  private:
   /* HeartBreath */
   HeartBreath _heart_breath = {0};
+  int64_t _heart_breath_time = 0;
 
   /* BreathRate */
   float _breath_rate;
+  int64_t _breath_rate_time = 0;
 
   /* HeartRate */
   float _heart_rate;
+  int64_t _heart_rate_time = 0;
 
   /* HeartBreathDistance */
   uint32_t _rangeFlag;
   float _range;
+  int64_t _range_time = 0;
 
   /* HumanDetection */
   bool _isHumanDetected;             // 0 : no one            1 : There is someone
   bool _isHumanDetectionValid;
 
   /* PeopleCounting PointCloud */
-  PeopleCounting _people_counting_point_cloud;
-  bool _isPeopleCountingPointCloudValid;
- 
+  MMWavePointCloud _point_cloud;
+  bool _isPeopleCountingPointCloudValid = false;
+
   /* PeopleCounting TargetInfo */
-  PeopleCounting _people_counting_target_info;
-  bool _isPeopleCountingTargetInfoValid;
+  MMWavePointCloud _target_info;
+  bool _isPeopleCountingTargetInfoValid = false;
+
+
+  /* History of every sample, independent of the getters above */
+  SeeedmmWaveSpscRing<PhaseSample, MR60BHA2_PHASE_HISTORY_SIZE> _phase_history;
+  SeeedmmWaveSpscRing<RateSample, MR60BHA2_RATE_HISTORY_SIZE>
+      _breath_rate_history;
+  SeeedmmWaveSpscRing<RateSample, MR60BHA2_RATE_HISTORY_SIZE>
+      _heart_rate_history;
+  SeeedmmWaveSpscRing<DistanceSample, MR60BHA2_DISTANCE_HISTORY_SIZE>
+      _distance_history;
 
+  /* Snapshot for any number of readers, see getVitals() */
+  MR60BHA2Vitals _vitals_draft = {};
+  SeeedmmWaveSeqLock<MR60BHA2Vitals> _vitals;
+  void publishVitals();
 
   FirmwareInfo _firmware_info;
   bool _isFirmwareInfoValid     = false;
@@ -95,23 +188,124 @@ class SEEED_MR60BHA2 : public SeeedmmWave {
   bool _isHeartRateValid        = false;
   bool _isDistanceValid         = false;
 
+  /* Receivers of the decoded payloads, see MR60BHA2_FRAME_TABLE */
+  void onHeartBreathPhase(const HeartBreath& phases);
+  void onBreathRate(const float& rate);
+  void onHeartRate(const float& rate);
+  void onDistance(const RangeReport& range);
+  void onHumanDetection(const uint8_t& detected);
+  void onPointCloud(const MMWaveFrameView& data);
+  void onTargetInfo(const MMWaveFrameView& data);
+  void onFirmware(const uint32_t& value);
+
  public:
   SEEED_MR60BHA2() {}
 
   virtual ~SEEED_MR60BHA2() {}
 
+  using SeeedmmWave::handleType;
   bool handleType(uint16_t _type, const uint8_t* data,
                   size_t data_len) override;
+  bool handleType(uint16_t _type, const MMWaveFrameView& data) override;
 
   bool getHeartBreathPhases(float& total_phase, float& breath_phase,
                             float& heart_phase);
   bool getBreathRate(float& rate);
   bool getHeartRate(float& rate);
   bool getDistance(float& distance);
+
+  /**
+   * @brief Same as the getters above, also returning the esp_timer time in
+   * microseconds at which the frame carrying the value was received.
+   */
+  bool getHeartBreathPhases(float& total_phase, float& breath_phase,
+                            float& heart_phase, int64_t& timestamp_us);
+  bool getBreathRate(float& rate, int64_t& timestamp_us);
+  bool getHeartRate(float& rate, int64_t& timestamp_us);
+  bool getDistance(float& distance, int64_t& timestamp_us);
+  /**
+   * @brief Move the oldest buffered samples of a signal into out.
+   *
+   * Every received sample is kept in a fixed-size ring until drained, so a
+   * consumer that wakes up only now and then still sees all of them. The
+   * rings are single-producer/single-consumer: they may be drained from
+   * another task than the one running update() or the RX task. Samples
+   * arriving while a ring is full are dropped and counted.
+   *
+   * @return The number of samples written to the front of out.
+   */
+  size_t drainHeartBreathPhases(std::span<PhaseSample> out) {
+    return _phase_history.drain(out);
+  }
+  size_t drainBreathRates(std::span<RateSample> out) {
+    return _breath_rate_history.drain(out);
+  }
+  size_t drainHeartRates(std::span<RateSample> out) {
+    return _heart_rate_history.drain(out);
+  }
+  size_t drainDistances(std::span<DistanceSample> out) {
+    return _distance_history.drain(out);
+  }
+  uint32_t getHistoryDropped() const {
+    return _phase_history.dropped() + _breath_rate_history.dropped() +
+           _heart_rate_history.dropped() + _distance_history.dropped();
+  }
+
+  /**
+   * @brief Latest point cloud or target list, in structure-of-arrays form.
+   *
+   * No allocation is made, by the reception path or by these getters.
+   */
+  bool getPointCloud(MMWavePointCloud& point_cloud);
+  bool getTargetInfo(MMWavePointCloud& target_info);
+
+  /**
+   * @brief Same as getPointCloud() and getTargetInfo(), converted to a
+   * vector of TargetN for existing callers.
+   */
   bool getPeopleCountingPointCloud(PeopleCounting& point_cloud);
   bool getPeopleCountingTargetInfo(PeopleCounting& target_info);
   bool isHumanDetected();
   bool getFirmwareInfo(FirmwareInfo& firmware_info);
+
+  /**
+   * @brief Consistent copy of the latest value of every vital sign.
+   *
+   * Unlike the getters above it consumes nothing and takes no lock: the
+   * snapshot is republished after every report, and any number of tasks
+   * may read it concurrently with the task handling the frames.
+   *
+   * @retval false No report has been received yet.
+   */
+  bool getVitals(MR60BHA2Vitals& vitals) const;
 };
 
+/**
+ * @brief Handle different types of heart and breath data.
+ *
+ * The switch is generated from MR60BHA2_FRAME_TABLE: each case checks the
+ * payload length against its layout, decodes it straight from the receive
+ * ring and passes the value to the member listed in the table. Reports
+ * shorter than their layout are rejected.
+ *
+ * Defined inline so that SeeedmmWaveT<SEEED_MR60BHA2> can inline the whole
+ * dispatch into its frame loop.
+ *
+ * @param _type The type identifier of the data.
+ * @param data The view of the payload, which may wrap around the ring.
+ * @return true if the data is handled successfully.
+ * @return false if there is an error in handling the data.
+ */
+inline bool SEEED_MR60BHA2::handleType(uint16_t _type,
+                                       const MMWaveFrameView& data) {
+  switch (_type) {
+#define X(name, type, payload, handler)                                        \
+  MMWAVE_DISPATCH_CASE(SEEED_MR60BHA2, type, payload, handler)
+    MR60BHA2_FRAME_TABLE(X)
+#undef X
+    default:
+      return false;  // Unhandled type
+  }
+}
+
 #endif /*SEEED_MR60BHA2_H*/
\ No newline at end of file
@@ -11,6 +11,10 @@
 
 #include "SEEED_MR60FDA2.h"
 
+#include <math.h>
+
+#include "esp_timer.h"
+
 /**
  * @brief Radar initialization.
  *
@@ -42,14 +46,14 @@ bool SEEED_MR60FDA2::resetSetting(void) {
  *
  */
 bool SEEED_MR60FDA2::setInstallationHeight(const float height) {
-  uint16_t type = static_cast<uint16_t>(TypeFallDetection::InstallationHeight);
+  int32_t id = setInstallationHeightAsync(height);
+  return id >= 0 && waitCommand(id) == MMWaveCommandStatus::Acked;
+}
 
-  uint8_t data[sizeof(float)] = {0};
-  floatToBytes(height, data);
-  if (this->send(type, data, sizeof(data))) {
-    return this->fetchType(type, 1000);
-  }
-  return false;
+int32_t SEEED_MR60FDA2::setInstallationHeightAsync(
+    const float height, MMWaveCommandCallback callback, void* ctx) {
+  return sendRequest<TypeFallDetection::InstallationHeight>(callback, ctx,
+                                                           height);
 }
 
 /**
@@ -60,19 +64,20 @@ bool SEEED_MR60FDA2::setInstallationHeight(const float height) {
  * @note The default fall threshold of the radar is 0.6 m.
  */
 bool SEEED_MR60FDA2::setThreshold(const float threshold) {
-  uint16_t type = static_cast<uint16_t>(TypeFallDetection::FallThreshold);
-
-  uint8_t data[sizeof(float)];
-  floatToBytes(threshold, data);
-  if (this->send(type, data, sizeof(data))) {
-    if (fetchType(type, 1000))  // Timeout of 5000 ms to fetch the response
-    {
-      return _isThresholdValid;
-    }
+  int32_t id = setThresholdAsync(threshold);
+  if (id >= 0 && waitCommand(id) == MMWaveCommandStatus::Acked) {
+    return _isThresholdValid;
   }
   return false;
 }
 
+int32_t SEEED_MR60FDA2::setThresholdAsync(const float threshold,
+                                          MMWaveCommandCallback callback,
+                                          void* ctx) {
+  return sendRequest<TypeFallDetection::FallThreshold>(callback, ctx,
+                                                      threshold);
+}
+
 /**
  * @brief Set the fall sensitivity
  *
@@ -84,19 +89,20 @@ bool SEEED_MR60FDA2::setThreshold(const float threshold) {
  * data.
  */
 bool SEEED_MR60FDA2::setSensitivity(const uint32_t _sensitivity) {
-  uint16_t type = static_cast<uint16_t>(TypeFallDetection::FallSensitivity);
-
-  uint8_t data[sizeof(uint32_t)];
-  uint32ToBytes(_sensitivity, data);
-  if (this->send(type, data, sizeof(data))) {
-    if (fetchType(type, 1000))  // Timeout of 5000 ms to fetch the response
-    {
-      return _isSensitivityValid;
-    }
+  int32_t id = setSensitivityAsync(_sensitivity);
+  if (id >= 0 && waitCommand(id) == MMWaveCommandStatus::Acked) {
+    return _isSensitivityValid;
   }
   return false;
 }
 
+int32_t SEEED_MR60FDA2::setSensitivityAsync(const uint32_t _sensitivity,
+                                            MMWaveCommandCallback callback,
+                                            void* ctx) {
+  return sendRequest<TypeFallDetection::FallSensitivity>(callback, ctx,
+                                                        _sensitivity);
+}
+
 /**
  * @brief Set the Alam Area object
  *
@@ -109,20 +115,23 @@ bool SEEED_MR60FDA2::setSensitivity(const uint32_t _sensitivity) {
  */
 bool SEEED_MR60FDA2::setAlamArea(const float rect_XL, const float rect_XR,
                                  const float rect_ZF, const float rect_ZB) {
-  uint8_t data[sizeof(float) * 4];
-  floatToBytes(rect_XL, data);
-  floatToBytes(rect_XR, data + sizeof(float));
-  floatToBytes(rect_ZF, data + 2 * sizeof(float));
-  floatToBytes(rect_ZB, data + 3 * sizeof(float));
-  uint16_t type = static_cast<uint16_t>(TypeFallDetection::AlarmParameters);
-  if (this->send(type, data, sizeof(data))) {
-    if (fetchType(type, 1000)) {
-      return _isAlarmAreaValid;
-    }
+  int32_t id = setAlamAreaAsync(rect_XL, rect_XR, rect_ZF, rect_ZB);
+  if (id >= 0 && waitCommand(id) == MMWaveCommandStatus::Acked) {
+    return _isAlarmAreaValid;
   }
   return false;
 }
 
+int32_t SEEED_MR60FDA2::setAlamAreaAsync(const float rect_XL,
+                                         const float rect_XR,
+                                         const float rect_ZF,
+                                         const float rect_ZB,
+                                         MMWaveCommandCallback callback,
+                                         void* ctx) {
+  return sendRequest<TypeFallDetection::AlarmParameters>(
+      callback, ctx, rect_XL, rect_XR, rect_ZF, rect_ZB);
+}
+
 /**
  * @brief get the basic Radar parameters
  *
@@ -184,21 +193,105 @@ bool SEEED_MR60FDA2::getRadarParameters(float& height, float& threshold,
  * @retval false failed to obtain
  */
 bool SEEED_MR60FDA2::getRadarParameters() {
-  uint16_t type = static_cast<uint16_t>(TypeFallDetection::RadarParameters);
-  if (this->send(type, nullptr, 0)) {
-    return fetchType(type, 1000);
+  int32_t id = getRadarParametersAsync();
+  return id >= 0 && waitCommand(id) == MMWaveCommandStatus::Acked;
+}
+
+/**
+ * @brief Request the radar parameters without waiting for them.
+ *
+ * The response record holds height, threshold, sensitivity and the four
+ * alarm area bounds in value[0] to value[6].
+ */
+int32_t SEEED_MR60FDA2::getRadarParametersAsync(MMWaveCommandCallback callback,
+                                                void* ctx) {
+  return sendRequest<TypeFallDetection::RadarParameters>(callback, ctx);
+}
+
+bool SEEED_MR60FDA2::readProfile(FallRadarProfile& profile) {
+  return getRadarParameters(profile.height, profile.threshold,
+                            profile.sensitivity, profile.rect_XL,
+                            profile.rect_XR, profile.rect_ZF, profile.rect_ZB);
+}
+
+// Values read back are the floats that were written, allow for rounding in
+// the sensor firmware all the same
+static bool sameParameter(float current, float wanted) {
+  return fabsf(current - wanted) < 1e-4f;
+}
+
+bool SEEED_MR60FDA2::applyProfile(const FallRadarProfile& profile,
+                                  FallRadarApplyResult* result) {
+  int64_t start_us = esp_timer_get_time();
+  FallRadarProfile current;
+  bool known = readProfile(current);
+
+  bool set_height = !known || !sameParameter(current.height, profile.height);
+  bool set_threshold =
+      !known || !sameParameter(current.threshold, profile.threshold);
+  bool set_sensitivity = !known || current.sensitivity != profile.sensitivity;
+  bool set_area = !known || !sameParameter(current.rect_XL, profile.rect_XL) ||
+                  !sameParameter(current.rect_XR, profile.rect_XR) ||
+                  !sameParameter(current.rect_ZF, profile.rect_ZF) ||
+                  !sameParameter(current.rect_ZB, profile.rect_ZB);
+
+  // Pipeline every command before awaiting the first acknowledgement
+  int32_t height_id = -1, threshold_id = -1, sensitivity_id = -1, area_id = -1;
+  uint8_t changed = 0;
+  if (set_height) {
+    _isHeightValid = false;
+    height_id      = setInstallationHeightAsync(profile.height);
+    changed++;
   }
-  return false;
+  if (set_threshold) {
+    _isThresholdValid = false;
+    threshold_id      = setThresholdAsync(profile.threshold);
+    changed++;
+  }
+  if (set_sensitivity) {
+    _isSensitivityValid = false;
+    sensitivity_id      = setSensitivityAsync(profile.sensitivity);
+    changed++;
+  }
+  if (set_area) {
+    _isAlarmAreaValid = false;
+    area_id = setAlamAreaAsync(profile.rect_XL, profile.rect_XR,
+                               profile.rect_ZF, profile.rect_ZB);
+    changed++;
+  }
+
+  // The flags are set by handleType() from each acknowledgement payload
+  uint8_t acked = 0;
+  if (height_id >= 0 && waitCommand(height_id) == MMWaveCommandStatus::Acked &&
+      _isHeightValid)
+    acked++;
+  if (threshold_id >= 0 &&
+      waitCommand(threshold_id) == MMWaveCommandStatus::Acked &&
+      _isThresholdValid)
+    acked++;
+  if (sensitivity_id >= 0 &&
+      waitCommand(sensitivity_id) == MMWaveCommandStatus::Acked &&
+      _isSensitivityValid)
+    acked++;
+  if (area_id >= 0 && waitCommand(area_id) == MMWaveCommandStatus::Acked &&
+      _isAlarmAreaValid)
+    acked++;
+
+  if (result) {
+    result->changed    = changed;
+    result->acked      = acked;
+    result->elapsed_us = esp_timer_get_time() - start_us;
+  }
+  return acked == changed;
 }
 
 // Only supports one-way data transmission mode
 bool SEEED_MR60FDA2::setUserLog(bool flag) {
   uint16_t type = static_cast<uint16_t>(TypeFallDetection::UserLogInfo);
 
-  uint8_t data[sizeof(uint32_t)] = {0};
-  uint32ToBytes(flag, data);
-  std::vector<uint8_t> frame = packetFrame(type, data, sizeof(data));
-  if (this->send(type, data, sizeof(data))) {
+  uint8_t data[MR60FDA2Request<TypeFallDetection::UserLogInfo>::Payload::kSize];
+  size_t len = encodeRequest<TypeFallDetection::UserLogInfo>(data, flag);
+  if (this->send(type, data, len)) {
     return true;
   }
   return false;
@@ -250,65 +343,74 @@ bool SEEED_MR60FDA2::getHuman() {
 }
 
 /**
- * @brief Handle different types of fall detection data.
- *
- * This function processes different types of fall detection data based on the
- * type identifier.
+ * @brief Latest point cloud or target list reported by the radar.
  *
- * @param _type The type identifier of the data.
- * @param data The pointer to the data buffer.
- * @param data_len The length of the data buffer.
- * @retval true if the data is handled successfully.
- * @retval false if there is an error in handling the data.
+ * @retval false No new report since the previous call.
  */
+bool SEEED_MR60FDA2::getPointCloud(MMWavePointCloud& point_cloud) {
+  if (!_isPointCloudValid)
+    return false;
+  _isPointCloudValid = false;
+  point_cloud        = _point_cloud;
+  return true;
+}
+
+bool SEEED_MR60FDA2::getTargetInfo(MMWavePointCloud& target_info) {
+  if (!_isTargetInfoValid)
+    return false;
+  _isTargetInfoValid = false;
+  target_info        = _target_info;
+  return true;
+}
+
 bool SEEED_MR60FDA2::handleType(uint16_t _type, const uint8_t* data,
                                 size_t data_len) {
-  TypeFallDetection type = static_cast<TypeFallDetection>(_type);
-  switch (type) {
-    case TypeFallDetection::ReportFallDetection:
-      _isFall      = *(const bool*)data;
-      _isFallValid = true;
-      break;
-    case TypeFallDetection::ReportUnmannedDetection:
-      _isHuman      = *(const uint8_t*)data;
-      _isHumanValid = true;
-      break;
-    case TypeFallDetection::InstallationHeight: {
-      if (data_len != 1)
-        return false;
-      _isHeightValid = *(const uint8_t*)data;
-      break;
-    }
-    case TypeFallDetection::RadarParameters: {
-      if (data_len <= 1)
-        return false;
-      _height          = extractFloat(data);
-      _thershold       = extractFloat(data + sizeof(float));
-      _sensitivity     = extractU32(data + 2 * sizeof(float));
-      _rect_XL         = extractFloat(data + 3 * sizeof(float));
-      _rect_XR         = extractFloat(data + 4 * sizeof(float));
-      _rect_ZF         = extractFloat(data + 5 * sizeof(float));
-      _rect_ZB         = extractFloat(data + 6 * sizeof(float));
-      _parametersValid = true;
-      break;
-    }
-    case TypeFallDetection::FallThreshold: {  // set fall threshold result
-      if (data_len != 1)
-        return false;
-      _isThresholdValid = *(const uint8_t*)data;
-      break;
-    }
-    case TypeFallDetection::AlarmParameters: {
-      _isAlarmAreaValid = *(const uint8_t*)data;
-      break;
-    }
-    case TypeFallDetection::FallSensitivity:
-      _isSensitivityValid = *(const uint8_t*)data;
-      break;
-    default:
-      return false;
-  }
-  return true;
+  return handleType(_type, MMWaveFrameView(data, data_len));
+}
+
+void SEEED_MR60FDA2::onFall(const uint8_t& is_fall) {
+  _isFall      = is_fall;
+  _isFallValid = true;
+}
+
+void SEEED_MR60FDA2::onHuman(const uint8_t& is_human) {
+  _isHuman      = is_human;
+  _isHumanValid = true;
+}
+
+void SEEED_MR60FDA2::onHeightAck(const uint8_t& applied) {
+  _isHeightValid = applied;
+}
+
+void SEEED_MR60FDA2::onThresholdAck(const uint8_t& applied) {
+  _isThresholdValid = applied;
+}
+
+void SEEED_MR60FDA2::onSensitivityAck(const uint8_t& applied) {
+  _isSensitivityValid = applied;
+}
+
+void SEEED_MR60FDA2::onAlarmAreaAck(const uint8_t& applied) {
+  _isAlarmAreaValid = applied;
+}
+
+void SEEED_MR60FDA2::onRadarParameters(const FallRadarProfile& profile) {
+  _height          = profile.height;
+  _thershold       = profile.threshold;
+  _sensitivity     = profile.sensitivity;
+  _rect_XL         = profile.rect_XL;
+  _rect_XR         = profile.rect_XR;
+  _rect_ZF         = profile.rect_ZF;
+  _rect_ZB         = profile.rect_ZB;
+  _parametersValid = true;
+}
+
+void SEEED_MR60FDA2::onPointCloud(const MMWaveFrameView& data) {
+  _isPointCloudValid = decodePointCloud(data, _point_cloud);
+}
+
+void SEEED_MR60FDA2::onTargetInfo(const MMWaveFrameView& data) {
+  _isTargetInfoValid = decodePointCloud(data, _target_info);
 }
 
 bool SEEED_MR60FDA2::getFallInternal() {
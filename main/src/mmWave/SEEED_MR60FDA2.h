@@ -13,24 +13,85 @@
 #define SEEED_MR60FDA2_H
 
 #include "SeeedmmWave.h"
+#include "SeeedmmWaveFrameTable.h"
+
+// clang-format off
+/**
+ * @brief Every frame type of the MR60FDA2, the single place to add one.
+ *
+ * X(name, type ID, payload layout of reports and responses, member receiving
+ *   the decoded payload or nullptr, payload layout of requests)
+ */
+#define MR60FDA2_FRAME_TABLE(X)                                                                                            \
+  X(UserLogInfo,                  0x010E, MMWaveNoPayload,         nullptr,                            MMWaveU32Payload)   \
+  X(Report3DPointCloudTargetInfo, 0x0A04, MMWavePointCloudPayload, &SEEED_MR60FDA2::onTargetInfo,      MMWaveNoPayload)    \
+  X(Report3DPointCloudDetection,  0x0A08, MMWavePointCloudPayload, &SEEED_MR60FDA2::onPointCloud,      MMWaveNoPayload)    \
+  X(ReportFallDetection,          0x0E02, MMWaveFlagPayload,       &SEEED_MR60FDA2::onFall,            MMWaveNoPayload)    \
+  X(InstallationHeight,           0x0E04, MMWaveFlagPayload,       &SEEED_MR60FDA2::onHeightAck,       MMWaveFloatPayload) \
+  X(RadarParameters,              0x0E06, RadarParametersPayload,  &SEEED_MR60FDA2::onRadarParameters, MMWaveNoPayload)    \
+  X(FallThreshold,                0x0E08, MMWaveFlagPayload,       &SEEED_MR60FDA2::onThresholdAck,    MMWaveFloatPayload) \
+  X(FallSensitivity,              0x0E0A, MMWaveFlagPayload,       &SEEED_MR60FDA2::onSensitivityAck,  MMWaveU32Payload)   \
+  X(AlarmParameters,              0x0E0C, MMWaveFlagPayload,       &SEEED_MR60FDA2::onAlarmAreaAck,    AlarmAreaPayload)   \
+  X(HeightUpload,                 0x0E0E, MMWaveNoPayload,         nullptr,                            MMWaveNoPayload)    \
+  X(ReportUnmannedDetection,      0x0F09, MMWaveFlagPayload,       &SEEED_MR60FDA2::onHuman,           MMWaveNoPayload)    \
+  X(RadarInitSetting,             0x2110, MMWaveNoPayload,         nullptr,                            MMWaveNoPayload)
+// clang-format on
 
 enum class TypeFallDetection : uint16_t {
-  UserLogInfo = 0x010E,
-
-  ReportFallDetection = 0x0E02,  // is_fall
-  InstallationHeight  = 0x0E04,
-  RadarParameters     = 0x0E06,
-  FallThreshold       = 0x0E08,
-  FallSensitivity     = 0x0E0A,
-
-  HeightUpload                  = 0x0E0E,
-  AlarmParameters               = 0x0E0C,
-  RadarInitSetting              = 0x2110,
-  Report3DPointCloudDetection   = 0x0A08,
-  Report3DPointCloudTargetInfo = 0x0A04,
-  ReportUnmannedDetection       = 0x0F09,
+#define X(name, type, payload, handler, request) MMWAVE_ENUM_VALUE(name, type)
+  MR60FDA2_FRAME_TABLE(X)
+#undef X
 };
 
+/**
+ * @brief Full set of configurable fall radar parameters.
+ */
+typedef struct FallRadarProfile {
+  float height;
+  float threshold;
+  uint32_t sensitivity;
+  float rect_XL;
+  float rect_XR;
+  float rect_ZF;
+  float rect_ZB;
+} FallRadarProfile;
+
+typedef struct FallAlarmArea {
+  float rect_XL;
+  float rect_XR;
+  float rect_ZF;
+  float rect_ZB;
+} FallAlarmArea;
+
+// Height, threshold, sensitivity and alarm area, in FallRadarProfile order
+typedef MMWavePayload<FallRadarProfile, float, float, uint32_t, float, float,
+                      float, float>
+    RadarParametersPayload;
+typedef MMWavePayload<FallAlarmArea, float, float, float, float>
+    AlarmAreaPayload;
+
+/**
+ * @brief Request layout of each frame type, from MR60FDA2_FRAME_TABLE.
+ */
+template <TypeFallDetection Type>
+struct MR60FDA2Request;
+#define X(name, type, payload, handler, request)                               \
+  template <>                                                                  \
+  struct MR60FDA2Request<TypeFallDetection::name> {                            \
+    typedef request Payload;                                                   \
+  };
+MR60FDA2_FRAME_TABLE(X)
+#undef X
+
+/**
+ * @brief Outcome of SEEED_MR60FDA2::applyProfile().
+ */
+typedef struct FallRadarApplyResult {
+  uint8_t changed;     // commands sent because the sensor differed
+  uint8_t acked;       // of those, acknowledged as applied
+  int64_t elapsed_us;  // from the parameter read to the last acknowledgement
+} FallRadarApplyResult;
+
 class SEEED_MR60FDA2 : public SeeedmmWave {
  private:
   /*  get parameters */
@@ -58,7 +119,46 @@ class SEEED_MR60FDA2 : public SeeedmmWave {
   bool _isHumanValid = false;
   bool _isFallValid  = false;
 
+  /* point cloud and target info */
+  MMWavePointCloud _point_cloud;
+  MMWavePointCloud _target_info;
+  bool _isPointCloudValid = false;
+  bool _isTargetInfoValid = false;
+
   bool getFallInternal();
+
+  /* Receivers of the decoded payloads, see MR60FDA2_FRAME_TABLE */
+  void onFall(const uint8_t& is_fall);
+  void onHuman(const uint8_t& is_human);
+  void onHeightAck(const uint8_t& applied);
+  void onThresholdAck(const uint8_t& applied);
+  void onSensitivityAck(const uint8_t& applied);
+  void onAlarmAreaAck(const uint8_t& applied);
+  void onRadarParameters(const FallRadarProfile& profile);
+  void onPointCloud(const MMWaveFrameView& data);
+  void onTargetInfo(const MMWaveFrameView& data);
+
+  /**
+   * @brief Encode the request of frame type T, laid out as in the table.
+   *
+   * @param data At least the request size bytes.
+   * @return The payload length.
+   */
+  template <TypeFallDetection T, typename... Args>
+  static size_t encodeRequest(uint8_t* data, Args... args) {
+    return MR60FDA2Request<T>::Payload::encode(data, args...);
+  }
+
+  template <TypeFallDetection T, typename... Args>
+  int32_t sendRequest(MMWaveCommandCallback callback, void* ctx,
+                      Args... args) {
+    typedef typename MR60FDA2Request<T>::Payload Request;
+    uint8_t data[Request::kSize ? Request::kSize : 1];
+    size_t len = encodeRequest<T>(data, args...);
+    return sendCommand(static_cast<uint16_t>(T), len ? data : nullptr, len,
+                       callback, ctx);
+  }
+
  protected:
   bool getRadarParameters();
 
@@ -67,8 +167,10 @@ class SEEED_MR60FDA2 : public SeeedmmWave {
 
   virtual ~SEEED_MR60FDA2() {}
 
+  using SeeedmmWave::handleType;
   bool handleType(uint16_t _type, const uint8_t* data,
                   size_t data_len) override;
+  bool handleType(uint16_t _type, const MMWaveFrameView& data) override;
 
   bool resetSetting(void);
 
@@ -80,18 +182,92 @@ class SEEED_MR60FDA2 : public SeeedmmWave {
   bool setAlamArea(const float rect_XL, const float rect_XR,
                    const float rect_ZF, const float rect_ZB);
 
+  /**
+   * @brief Non-blocking versions of the setters above.
+   *
+   * The command is only sent; report frames keep flowing while it is in
+   * flight. The outcome is passed to the callback, or collected with
+   * getCommandStatus()/waitCommand() when none is given. The one byte
+   * acknowledgement is response->value[0].u.
+   *
+   * @return The frame ID of the command, -1 if it could not be queued.
+   */
+  int32_t setInstallationHeightAsync(const float height,
+                                     MMWaveCommandCallback callback = nullptr,
+                                     void* ctx                      = nullptr);
+  int32_t setThresholdAsync(const float threshold,
+                            MMWaveCommandCallback callback = nullptr,
+                            void* ctx                      = nullptr);
+  int32_t setSensitivityAsync(const uint32_t _sensitivity,
+                              MMWaveCommandCallback callback = nullptr,
+                              void* ctx                      = nullptr);
+  int32_t setAlamAreaAsync(const float rect_XL, const float rect_XR,
+                           const float rect_ZF, const float rect_ZB,
+                           MMWaveCommandCallback callback = nullptr,
+                           void* ctx                      = nullptr);
+  int32_t getRadarParametersAsync(MMWaveCommandCallback callback = nullptr,
+                                  void* ctx                      = nullptr);
+
   bool getRadarParameters(float& height, float& threshold,
                           uint32_t& sensitivity);
   bool getRadarParameters(float& height, float& threshold,
                           uint32_t& sensitivity, float& rect_XL, float& rect_XR,
                           float& rect_ZF, float& rect_ZB);
 
+  /**
+   * @brief Read every configurable parameter in one round-trip.
+   */
+  bool readProfile(FallRadarProfile& profile);
+
+  /**
+   * @brief Bring the sensor configuration to profile.
+   *
+   * The current parameters are read once and only the commands whose values
+   * differ are sent, back-to-back, before any acknowledgement is awaited;
+   * the acknowledgements are then collected together. If the current state
+   * cannot be read every parameter is sent.
+   *
+   * @param result Optional, filled with what was sent and the time it took.
+   * @retval true Every parameter sent was acknowledged as applied.
+   */
+  bool applyProfile(const FallRadarProfile& profile,
+                    FallRadarApplyResult* result = nullptr);
+
   // bool get3DPointCloud(const int option);
 
+  bool getPointCloud(MMWavePointCloud& point_cloud);
+  bool getTargetInfo(MMWavePointCloud& target_info);
+
   bool getFall(bool &is_fall);
   bool getHuman(bool &is_human);
   bool getFall();
   bool getHuman();
 };
 
+/**
+ * @brief Handle different types of fall detection data.
+ *
+ * The switch is generated from MR60FDA2_FRAME_TABLE, as for the MR60BHA2;
+ * acknowledgements of the setters are one byte flags like the reports.
+ *
+ * Defined inline so that SeeedmmWaveT<SEEED_MR60FDA2> can inline the whole
+ * dispatch into its frame loop.
+ *
+ * @param _type The type identifier of the data.
+ * @param data The view of the payload, which may wrap around the ring.
+ * @retval true if the data is handled successfully.
+ * @retval false if there is an error in handling the data.
+ */
+inline bool SEEED_MR60FDA2::handleType(uint16_t _type,
+                                       const MMWaveFrameView& data) {
+  switch (_type) {
+#define X(name, type, payload, handler, request)                               \
+  MMWAVE_DISPATCH_CASE(SEEED_MR60FDA2, type, payload, handler)
+    MR60FDA2_FRAME_TABLE(X)
+#undef X
+    default:
+      return false;
+  }
+}
+
 #endif /*SEEED_MR60FDA2_H*/
\ No newline at end of file
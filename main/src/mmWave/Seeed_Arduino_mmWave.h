@@ -16,6 +16,7 @@
 
 #include "SEEED_MR60BHA2.h"
 #include "SEEED_MR60FDA2.h"
+#include "SeeedmmWaveStatic.h"
 
 typedef enum {
   MMWAVE_DEVICE_RESERVE = 0,
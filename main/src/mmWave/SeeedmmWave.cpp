@@ -1,5 +1,15 @@
 #include "SeeedmmWave.h"
 
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_cpu.h"
+#include "esp_timer.h"
+
+#if MMWAVE_DIAG_METRICS
+#  include "esp_diagnostics_metrics.h"
+#endif
+
 /**
  * @brief Print the buffer content in hexadecimal format.
  *
@@ -9,8 +19,8 @@
  * format. If the buffer contains more than 5 bytes, it highlights the 6th and
  * 7th bytes by enclosing them in brackets.
  */
-void printHexBuff(const std::vector<uint8_t>& buffer) {
-  if (buffer.size() < 5) {
+void printHexBuff(const uint8_t* buffer, size_t len) {
+  if (len < 5) {
     // Buffer size is too small to process
     Serial.println("Buffer too small");
     return;
@@ -18,8 +28,8 @@ void printHexBuff(const std::vector<uint8_t>& buffer) {
 
   uint16_t data_size = buffer[3] << 8 | buffer[4];
 
-  for (size_t i = 0; i < buffer.size(); ++i) {
-    if (i == 5 && i + 1 < buffer.size()) {
+  for (size_t i = 0; i < len; ++i) {
+    if (i == 5 && i + 1 < len) {
       Serial.print("[");
       Serial.print(buffer[i] < 16 ? "0" : "");
       Serial.print(buffer[i], HEX);
@@ -28,7 +38,7 @@ void printHexBuff(const std::vector<uint8_t>& buffer) {
       Serial.print(buffer[i + 1], HEX);
       Serial.print("] ");
       ++i;  // Skip the next byte as it's already printed
-    } else if (i > 7 && data_size > 0 && i + data_size <= buffer.size()) {
+    } else if (i > 7 && data_size > 0 && i + data_size <= len) {
       Serial.print("[");
       size_t j = i;
       for (; j < i + data_size - 1; ++j) {
@@ -50,6 +60,10 @@ void printHexBuff(const std::vector<uint8_t>& buffer) {
   Serial.println();
 }
 
+void printHexBuff(const std::vector<uint8_t>& buffer) {
+  printHexBuff(buffer.data(), buffer.size());
+}
+
 /**
  * @brief Calculate the expected frame length from the buffer.
  *
@@ -113,21 +127,7 @@ bool SeeedmmWave::validateChecksum(const uint8_t* data, size_t len,
  * @param bytes The byte array to store the converted value.
  */
 void SeeedmmWave::floatToBytes(float value, uint8_t* bytes) {
-  union {
-    float f;
-    uint8_t bytes[sizeof(float)];
-  } floatUnion;
-
-  floatUnion.f = value;
-#if SEEED_WAVE_IS_BIG_ENDIAN == 1
-  for (size_t i = 0; i < sizeof(float); ++i) {
-    bytes[i] = floatUnion.bytes[sizeof(float) - 1 - i];
-  }
-#else
-  for (size_t i = 0; i < sizeof(float); ++i) {
-    bytes[i] = floatUnion.bytes[i];
-  }
-#endif
+  MMWaveWire<float>::encode(value, bytes);
 }
 
 /**
@@ -139,20 +139,17 @@ void SeeedmmWave::floatToBytes(float value, uint8_t* bytes) {
  * @param bytes The byte array to store the converted value.
  */
 void SeeedmmWave::uint32ToBytes(uint32_t value, uint8_t* bytes) {
-  uint8_t* p = reinterpret_cast<uint8_t*>(&value);
-  for (size_t i = 0; i < sizeof(uint32_t); ++i) {
-    bytes[i] = p[i];
-  }
+  MMWaveWire<uint32_t>::encode(value, bytes);
 }
 
 /**
  * @brief Extract a float value from a byte array.
  *
- * @param bytes The byte array containing the float value.
+ * @param bytes The byte array containing the float value, at any alignment.
  * @return The extracted float value.
  */
 float SeeedmmWave::extractFloat(const uint8_t* bytes) const {
-  return *reinterpret_cast<const float*>(bytes);
+  return MMWaveWire<float>::decode(bytes);
 }
 
 /**
@@ -161,34 +158,110 @@ float SeeedmmWave::extractFloat(const uint8_t* bytes) const {
  * This function extracts a 32-bit unsigned integer from the provided byte
  * array.
  *
- * @param bytes The byte array containing the 32-bit unsigned integer.
+ * @param bytes The byte array containing the 32-bit unsigned integer, at any
+ * alignment.
  * @return The extracted 32-bit unsigned integer.
  */
 uint32_t SeeedmmWave::extractU32(const uint8_t* bytes) const {
-  return *reinterpret_cast<const uint32_t*>(bytes);
+  return MMWaveWire<uint32_t>::decode(bytes);
+}
+
+/**
+ * @brief Extract a float value from a payload view.
+ *
+ * @param data The payload, possibly wrapping around the receive ring.
+ * @param offset The byte offset of the value in the payload.
+ * @return The extracted float value, 0 if the payload is too short.
+ */
+float SeeedmmWave::extractFloat(const MMWaveFrameView& data,
+                                size_t offset) const {
+  uint8_t bytes[sizeof(float)];
+  data.copy(bytes, offset, sizeof(bytes));
+  return extractFloat(bytes);
+}
+
+/**
+ * @brief Extract a 32-bit unsigned integer from a payload view.
+ *
+ * @param data The payload, possibly wrapping around the receive ring.
+ * @param offset The byte offset of the value in the payload.
+ * @return The extracted value, 0 if the payload is too short.
+ */
+uint32_t SeeedmmWave::extractU32(const MMWaveFrameView& data,
+                                 size_t offset) const {
+  uint8_t bytes[sizeof(uint32_t)];
+  data.copy(bytes, offset, sizeof(bytes));
+  return extractU32(bytes);
+}
+
+/**
+ * @brief Decode a point cloud or target info report.
+ *
+ * The payload is a target count followed by MMWAVE_POINT_SIZE bytes per
+ * target. The count is never trusted: only the targets actually present in
+ * the payload, and at most MMWAVE_POINT_CLOUD_CAPACITY, are decoded.
+ *
+ * @param data The payload, possibly wrapping around the receive ring.
+ * @param cloud Filled with the targets and the frame timestamp.
+ * @retval false The payload is too short to hold the target count.
+ */
+bool SeeedmmWave::decodePointCloud(const MMWaveFrameView& data,
+                                   MMWavePointCloud& cloud) const {
+  uint32_t count;
+  if (!MMWavePayload<uint32_t, uint32_t>::decode(data, count))
+    return false;
+  size_t present = (data.size() - sizeof(uint32_t)) / MMWAVE_POINT_SIZE;
+  if (count > present)
+    count = present;
+  if (count > MMWAVE_POINT_CLOUD_CAPACITY)
+    count = MMWAVE_POINT_CLOUD_CAPACITY;
+
+  uint8_t wrapped[MMWAVE_POINT_SIZE];
+  size_t offset = sizeof(uint32_t);
+  for (size_t i = 0; i < count; i++, offset += MMWAVE_POINT_SIZE) {
+    const uint8_t* target = data.first() + offset;
+    if (offset + MMWAVE_POINT_SIZE > data.firstLength()) {
+      data.copy(wrapped, offset, MMWAVE_POINT_SIZE);
+      target = wrapped;
+    }
+    cloud.x[i]       = MMWaveWire<float>::decode(target);
+    cloud.y[i]       = MMWaveWire<float>::decode(target + 4);
+    cloud.dop[i]     = MMWaveWire<int32_t>::decode(target + 8);
+    cloud.cluster[i] = MMWaveWire<int32_t>::decode(target + 12);
+  }
+  cloud.count        = count;
+  cloud.timestamp_us = frameTimestamp();
+  return true;
 }
 
 /**
  * @brief Initialize the SeeedmmWave object.
  *
  *
- * @param serial Pointer to the hardware serial object.
- * @param baud The baud rate for the serial communication.
+ * @param transport The link to the sensor, a serial port on the ESP32.
+ * @param baud The baud rate for the serial communication, 0 for links
+ * without a line rate; frames are then not back-dated to their SOF.
  * @param wait_delay The delay time to wait for the sensor.
  * @param rst The reset pin number. If negative, no reset is performed.
  *
- * @note This function initializes the SeeedmmWave object by setting the serial
- * port, baud rate, wait delay, and optionally resetting the hardware.
+ * @note This function initializes the SeeedmmWave object by setting the
+ * transport, baud rate, wait delay, and optionally resetting the hardware.
  */
-void SeeedmmWave::begin(HardwareSerial* serial, uint32_t baud,
+void SeeedmmWave::begin(SeeedmmWaveTransport* transport, uint32_t baud,
                         uint32_t wait_delay, int rst) {
-  this->_serial     = serial;
+  this->_transport  = transport;
   this->_baud       = baud;
   this->_wait_delay = wait_delay;
 
-  _serial->setRxBufferSize(1024 * 32);
-  _serial->begin(_baud);
-  _serial->setTimeout(1000);
+  // 8N1: ten bit times per byte, none without a baud rate
+  _parser.setByteTime(_baud ? 10000000000ULL / _baud : 0);
+  // Responses echo the ID of their request, out of the report sequence
+  _parser.setIdFilter(isCommandId, this);
+
+  _transport->begin(_baud);
+  if (_fetch_mode == FetchMode::EventDriven) {
+    attachRxEvent();
+  }
 
   // _serial->setRxFIFOFull(20);
   if (rst >= 0) {
@@ -209,7 +282,7 @@ void SeeedmmWave::begin(HardwareSerial* serial, uint32_t baud,
  * @return The number of bytes available.
  */
 int SeeedmmWave::available() {
-  return _serial ? _serial->available() : 0;
+  return _transport ? _transport->available() : 0;
 }
 
 /**
@@ -220,19 +293,24 @@ int SeeedmmWave::available() {
  * @return The number of bytes actually read.
  */
 int SeeedmmWave::read(char* data, int length) {
-  return _serial ? _serial->readBytes(data, length) : 0;
+  if (!_transport || length <= 0)
+    return 0;
+  return _transport->read(reinterpret_cast<uint8_t*>(data), length);
 }
 
 int SeeedmmWave::read(void) {
-  return _serial ? _serial->read() : 0;
+  if (!_transport)
+    return 0;
+  uint8_t byte;
+  return _transport->read(&byte, 1) ? byte : -1;
 }
 
 size_t SeeedmmWave::write(const uint8_t* buffer, size_t size) {
-  return _serial ? _serial->write(buffer, size) : 0;
+  return _transport ? _transport->write(buffer, size) : 0;
 }
 
 size_t SeeedmmWave::write(const char* buffer, size_t size) {
-  return _serial ? _serial->write(buffer, size) : 0;
+  return write(reinterpret_cast<const uint8_t*>(buffer), size);
 }
 
 /**
@@ -251,17 +329,13 @@ bool SeeedmmWave::processFrame(const uint8_t* frame_bytes, size_t len,
   if (len < SIZE_FRAME_HEADER)
     return false;  // Not enough data to process header
 
-  uint16_t id        = (frame_bytes[1] << 8) | frame_bytes[2];
   uint16_t data_len  = (frame_bytes[3] << 8) | frame_bytes[4];
-  uint16_t type      = (frame_bytes[5] << 8) | frame_bytes[6];
   uint8_t head_cksum = frame_bytes[7];
+  if (len < size_t(SIZE_FRAME_HEADER + data_len + SIZE_DATA_CKSUM))
+    return false;
   uint8_t data_cksum = frame_bytes[SIZE_FRAME_HEADER + data_len];
 
-  // Only proceed if the type matches or if data_type is set to the default,
-  // indicating no specific type is required
-  if (data_type != 0xFFFF && data_type != type)
-    return false;
-  // Checksum validation6
+  // Checksum validation
   if (!validateChecksum(frame_bytes, SIZE_FRAME_HEADER - SIZE_DATA_CKSUM,
                         head_cksum) ||
       !validateChecksum(&frame_bytes[SIZE_FRAME_HEADER], data_len,
@@ -269,151 +343,287 @@ bool SeeedmmWave::processFrame(const uint8_t* frame_bytes, size_t len,
     return false;
   }
 
-  return handleType(type, &frame_bytes[SIZE_FRAME_HEADER], data_len);
+  uint16_t type        = (frame_bytes[5] << 8) | frame_bytes[6];
+  _frame_timestamp_us = esp_timer_get_time();
+  return dispatchFrame(
+      type, MMWaveFrameView(&frame_bytes[SIZE_FRAME_HEADER], data_len),
+      data_type);
 }
 
-std::vector<uint8_t> SeeedmmWave::packetFrame(uint16_t type,
-                                              const uint8_t* data, size_t len) {
-  static uint16_t _id = 0x8000;
-  std::vector<uint8_t>
-      frame;  // SOF, ID, LEN, TYPE, HEAD_CKSUM, DATA, DATA_CKSUM
-
-  frame.push_back(SOF_BYTE);     // Start of Frame
-  frame.push_back(_id >> 8);     // ID high byte
-  frame.push_back(_id & 0xFF);   // ID low byte
-  frame.push_back(len >> 8);     // Length high byte
-  frame.push_back(len & 0xFF);   // Length low byte
-  frame.push_back(type >> 8);    // Type high byte
-  frame.push_back(type & 0xFF);  // Type low byte
-
-  uint8_t head_cksum = calculateChecksum(frame.data(), frame.size());
-  frame.push_back(head_cksum);  // Header checksum
+/**
+ * @brief Hand the payload of a frame whose checksums are already verified to
+ * handleType().
+ *
+ * @param type The type of the frame.
+ * @param data The payload of the frame.
+ * @param data_type The expected data type of the frame. Defaults to 0xFFFF.
+ * @return True if the frame is successfully processed, false otherwise.
+ */
+bool SeeedmmWave::dispatchFrame(uint16_t type, const MMWaveFrameView& data,
+                                uint16_t data_type) {
+  // Only proceed if the type matches or if data_type is set to the default,
+  // indicating no specific type is required
+  if (data_type != 0xFFFF && data_type != type)
+    return false;
 
-  if (data != nullptr) {
-    frame.insert(frame.end(), data, data + len);  // Insert data
+  return handleType(type, data);
+}
 
-    uint8_t data_cksum = calculateChecksum(data, len);
-    frame.push_back(data_cksum);  // Data checksum
+bool SeeedmmWave::handleType(uint16_t _type, const MMWaveFrameView& data) {
+  if (data.contiguous()) {
+    return handleType(_type, data.first(), data.size());
   }
-
-  _id++;
-  return frame;
+  uint8_t linear[FRAME_BUFFER_SIZE];
+  size_t len = data.copy(linear, 0, sizeof(linear));
+  return handleType(_type, linear, len);
 }
 
-bool SeeedmmWave::sendFrame(const std::vector<uint8_t>& frame) {
-#if _MMWAVE_DEBUG == 1
-  Serial.print("Send<<<");
-  printHexBuff(frame);
-#endif
-
-  size_t totalBytesSent = 0;
-  size_t frameSize      = frame.size();
-  const uint8_t* data   = frame.data();
-
-  while (totalBytesSent < frameSize) {
-    size_t bytesToSend = frameSize - totalBytesSent;
-    size_t bytesSent   = _serial->write(data + totalBytesSent, bytesToSend);
-
-    // Ensure all bytes are actually written
-    if (bytesSent > 0) {
-      totalBytesSent += bytesSent;
-    } else {
-      // Handle the case where no bytes are sent
-      Serial.println("Error: No bytes sent, retrying...");
-    }
+size_t SeeedmmWave::packetFrame(uint16_t type, uint16_t id,
+                                const uint8_t* data, size_t len,
+                                uint8_t* frame) {
+  // SOF, ID, LEN, TYPE, HEAD_CKSUM, DATA, DATA_CKSUM
+  frame[0] = SOF_BYTE;     // Start of Frame
+  frame[1] = id >> 8;      // ID high byte
+  frame[2] = id & 0xFF;    // ID low byte
+  frame[3] = len >> 8;     // Length high byte
+  frame[4] = len & 0xFF;   // Length low byte
+  frame[5] = type >> 8;    // Type high byte
+  frame[6] = type & 0xFF;  // Type low byte
+  frame[7] = calculateChecksum(frame, SIZE_FRAME_HEADER - SIZE_HEAD_CKSUM);
 
-    // Wait for the data to be sent
-    _serial->flush();
+  size_t frame_len = SIZE_FRAME_HEADER;
+  if (data != nullptr) {
+    memcpy(&frame[frame_len], data, len);  // Insert data
+    frame_len += len;
+    frame[frame_len++] = calculateChecksum(data, len);  // Data checksum
   }
-
-  return totalBytesSent == frameSize;
+  return frame_len;
 }
 
 /**
  * @brief Send a frame of data.
  *
- * @attention This function constructs and sends a frame of data, including
- * the frame header, data, and checksums.
+ * @attention This function constructs and queues a frame of data, including
+ * the frame header, data, and checksums. It does not wait for the frame to
+ * leave the UART, see sendAsync().
  *
  * @param type The type of the frame.
  * @param data The data to include in the frame. Defaults to nullptr.
  * @param len The length of the data. Defaults to 0.
- * @return True if the frame is sent successfully, false otherwise.
+ * @return True if the frame is queued successfully, false otherwise.
  */
 bool SeeedmmWave::send(uint16_t type, const uint8_t* data, size_t data_len) {
-  std::vector<uint8_t> frame = packetFrame(type, data, data_len);
-  return sendFrame(frame);
+  return sendAsync(type, data, data_len);
 }
 
-void SeeedmmWave::fetch(uint32_t timeout) {
-  static bool startFrame = false;
-  static std::vector<uint8_t> frameBuffer;
-  uint32_t expire_time = millis() + timeout;
-  uint8_t frameDataSize;
-  do {
-    size_t c_available = _serial->available();
-    while (c_available--) {
-      uint8_t byte = _serial->read();
-      if (startFrame)  // Frame processing
-      {
-        frameBuffer.push_back(byte);
-        // Serial.print("Read byte: ");
-        // Serial.println(byte, HEX);
-        if (frameBuffer.size() >= SIZE_FRAME_HEADER)  // right package
-        {
-          frameDataSize = (frameBuffer[3] << 8 | frameBuffer[4]);
-          if (frameDataSize > 30) {
-            startFrame = false;
-            // Serial.println("FrameDataSize too large, clearing buffer");
-            continue;
-          }
-          if (frameBuffer.size() ==
-              (SIZE_FRAME_HEADER + frameDataSize + SIZE_DATA_CKSUM)) {
-            if (byteQueue.size() >= MMWaveMaxQueueSize) {
-              byteQueue.pop();  // Discard the oldest frame
-              // Serial.println("Queue full, discarding oldest frame");
-            }
-#if _MMWAVE_DEBUG == 1
-            printHexBuff(frameBuffer);
-#endif
-            byteQueue.push(frameBuffer);  // Add the complete frame to the queue
-            startFrame = false;
-          }
-        }
-      } else {
-        if (byte == SOF_BYTE) {  // Start of frame
-          startFrame = true;
-          frameBuffer.clear();
-          frameBuffer.push_back(byte);  // insert 0x01
-          // Serial.println("Start of Frame detected 0x01");
-        }
-      }
-    }
-  } while (millis() < expire_time);
+bool SeeedmmWave::sendAsync(uint16_t type, const uint8_t* data,
+                            size_t data_len, uint32_t* ticket) {
+  if (!_transport || !queueFrame(type, nextTxId(), data, data_len, ticket))
+    return false;
+  kickTx();
+  return true;
 }
 
-bool SeeedmmWave::processQueuedFrames(uint16_t data_type, uint32_t timeout) {
-  bool result = false;
+bool SeeedmmWave::queueFrame(uint16_t type, uint16_t id, const uint8_t* data,
+                             size_t data_len, uint32_t* ticket) {
+  if (data_len > MMWAVE_TX_MAX_PAYLOAD)
+    return false;
+
+  portENTER_CRITICAL(&_tx_lock);
+  uint32_t head = _tx_head.load(std::memory_order_relaxed);
+  bool full =
+      head - _tx_tail.load(std::memory_order_acquire) == MMWAVE_TX_QUEUE_SIZE;
+  if (!full) {
+    TxFrame& frame = _tx_queue[head % MMWAVE_TX_QUEUE_SIZE];
+    frame.len      = packetFrame(type, id, data, data_len, frame.bytes);
+    _tx_head.store(head + 1, std::memory_order_release);
+  }
+  portEXIT_CRITICAL(&_tx_lock);
 
-  if (byteQueue.empty()) {
+  if (full)
     return false;
+  if (ticket)
+    *ticket = head;
+  return true;
+}
+
+/**
+ * @brief Get queued frames moving: write them now if this task owns the
+ * UART, else wake the RX task to do it.
+ */
+void SeeedmmWave::kickTx() {
+  if (ownsReceivePath()) {
+    pumpTx();
+  } else if (_rx_event) {
+    xSemaphoreGive(_rx_event);
   }
+}
 
-  uint32_t expire_time = millis() + timeout;
-  do {
-    std::vector<uint8_t> frame = byteQueue.front();
-    byteQueue.pop();
+/**
+ * @brief Write queued frames as far as the UART TX buffer has room.
+ *
+ * Only the task owning the receive path calls this, so the consumer side of
+ * the TX queue needs no lock.
+ */
+void SeeedmmWave::pumpTx() {
+  uint32_t tail = _tx_tail.load(std::memory_order_relaxed);
+  while (tail != _tx_head.load(std::memory_order_acquire)) {
+    const TxFrame& frame = _tx_queue[tail % MMWAVE_TX_QUEUE_SIZE];
+    size_t room          = _transport->availableForWrite();
+    if (room == 0)
+      break;
+    size_t len = frame.len - _tx_pos;
+    if (len > room)
+      len = room;
+    size_t sent = _transport->write(frame.bytes + _tx_pos, len);
+    _tx_pos += sent;
+    if (_tx_pos < frame.len)
+      break;
 #if _MMWAVE_DEBUG == 1
-    printHexBuff(frame);  // Print received bytes
+    Serial.print("Send<<<");
+    printHexBuff(frame.bytes, frame.len);
 #endif
-    if (!this->processFrame(frame.data(), frame.size(), data_type)) {
-      continue;
-    } else {
-      result = true;
+    _tx_pos = 0;
+    _tx_tail.store(++tail, std::memory_order_release);
+  }
+}
+
+bool SeeedmmWave::flushTx(uint32_t timeout) {
+  uint32_t expire_time = millis() + timeout;
+  for (;;) {
+    if (ownsReceivePath() && _transport)
+      pumpTx();
+    if (_tx_tail.load(std::memory_order_acquire) ==
+        _tx_head.load(std::memory_order_acquire))
+      return true;
+    if ((int32_t)(expire_time - millis()) <= 0)
+      return false;
+    vTaskDelay(1);
+  }
+}
+
+/**
+ * @brief Register the RX callback used by FetchMode::EventDriven.
+ *
+ * The callback runs in the transport's own task, the HardwareSerial event
+ * task on the ESP32, whenever bytes arrive, and only releases the binary
+ * semaphore fetch() is sleeping on. When the transport cannot signal
+ * arrivals, fetch() polls instead.
+ */
+void SeeedmmWave::attachRxEvent() {
+  if (_rx_event == nullptr) {
+    _rx_event = xSemaphoreCreateBinaryStatic(&_rx_event_buffer);
+  }
+  if (_transport) {
+    _rx_event_attached = _transport->onReceive(signalRxEvent, this);
+  }
+}
+
+void SeeedmmWave::signalRxEvent(void* arg) {
+  xSemaphoreGive(static_cast<SeeedmmWave*>(arg)->_rx_event);
+}
+
+/**
+ * @brief Select how fetch() waits for sensor data.
+ *
+ * @param mode FetchMode::Polling keeps the historical behaviour of spinning
+ * for the whole timeout. FetchMode::EventDriven blocks on UART RX events and
+ * returns as soon as at least one complete frame is queued, the timeout
+ * being only an upper bound.
+ */
+void SeeedmmWave::setFetchMode(FetchMode mode) {
+  _fetch_mode = mode;
+  if (mode == FetchMode::EventDriven) {
+    attachRxEvent();
+  } else if (_transport) {
+    _transport->onReceive(nullptr, nullptr);
+    _rx_event_attached = false;
+  }
+}
+
+void SeeedmmWave::resetFetchStats() {
+  memset(_fetch_stats, 0, sizeof(_fetch_stats));
+}
+
+/**
+ * @brief Bulk-read everything buffered by the transport and assemble frames.
+ *
+ * @return The number of complete frames pushed to the queue.
+ */
+size_t SeeedmmWave::drainSerial() {
+  size_t frames  = 0;
+  size_t pending = _transport->available();
+
+  while (pending) {
+    size_t room;
+    uint8_t* dst = _parser.writeBuffer(room);
+    size_t got   = _transport->read(dst, pending < room ? pending : room);
+    if (got == 0)
+      break;
+    _parser.commit(got, _transport->receiveTime());
+    pending -= got;
+    _fetch_stats[static_cast<uint8_t>(_fetch_mode)].bytes += got;
+
+    while (_parser.next()) {
+      frames++;
     }
-  } while (!byteQueue.empty() && timeout);
+  }
+  return frames;
+}
 
-  return result;
+/**
+ * @brief Receive frames from the sensor into the frame queue.
+ *
+ * @param timeout Upper bound in milliseconds. In FetchMode::Polling the whole
+ * timeout is always spent reading; in FetchMode::EventDriven the call returns
+ * as soon as at least one complete frame is queued.
+ */
+void SeeedmmWave::fetch(uint32_t timeout) {
+  if (!_transport || !ownsReceivePath())
+    return;
+
+  FetchStats& stats    = _fetch_stats[static_cast<uint8_t>(_fetch_mode)];
+  int64_t start_us     = esp_timer_get_time();
+  int64_t blocked_us   = 0;
+  uint32_t expire_time = millis() + timeout;
+
+  if (_fetch_mode == FetchMode::EventDriven && _rx_event_attached) {
+    for (;;) {
+      pumpTx();
+      uint32_t cycles = esp_cpu_get_cycle_count();
+      stats.frames += drainSerial();
+      stats.parse_cycles += esp_cpu_get_cycle_count() - cycles;
+      if (!_parser.empty())
+        break;
+      int32_t remaining = (int32_t)(expire_time - millis());
+      if (remaining <= 0)
+        break;
+      // A tick is 10 ms with CONFIG_FREERTOS_HZ=100, never wait for 0 ticks
+      TickType_t ticks = pdMS_TO_TICKS(remaining);
+      int64_t wait_us  = esp_timer_get_time();
+      xSemaphoreTake(_rx_event, ticks ? ticks : 1);
+      blocked_us += esp_timer_get_time() - wait_us;
+    }
+  } else {
+    do {
+      pumpTx();
+      uint32_t cycles = esp_cpu_get_cycle_count();
+      stats.frames += drainSerial();
+      stats.parse_cycles += esp_cpu_get_cycle_count() - cycles;
+    } while ((int32_t)(expire_time - millis()) > 0);
+  }
+
+  int64_t wall_us = esp_timer_get_time() - start_us;
+  stats.calls++;
+  stats.wall_us += wall_us;
+  stats.busy_us += wall_us - blocked_us;
+}
+
+bool SeeedmmWave::processQueuedFrames(uint16_t data_type, uint32_t timeout) {
+  return processFramesWith(
+      data_type, timeout, [this](uint16_t type, const MMWaveFrameView& data) {
+        return handleType(type, data);
+      });
 }
 
 /**
@@ -425,10 +635,390 @@ bool SeeedmmWave::processQueuedFrames(uint16_t data_type, uint32_t timeout) {
  */
 bool SeeedmmWave::update(uint32_t timeout) {
   this->fetch(timeout);
-  return processQueuedFrames(0xFFFF, timeout);
+  bool result = processQueuedFrames(0xFFFF, timeout);
+  expireCommands();
+  return result;
 }
 
 bool SeeedmmWave::fetchType(uint16_t data_type, uint32_t timeout) {
   this->fetch(timeout);
   return processQueuedFrames(data_type);
 }
+
+/**
+ * @brief Whether the calling task may read and process frames.
+ *
+ * Once the RX task runs it is the only owner of the parser and frame queue.
+ */
+bool SeeedmmWave::ownsReceivePath() const {
+  return _rx_task == nullptr || xTaskGetCurrentTaskHandle() == _rx_task;
+}
+
+void SeeedmmWave::decodeRecord(const MMWaveFrame& frame,
+                               const MMWaveFrameView& data,
+                               MMWaveRecord& record) const {
+  record.timestamp_us = frame.timestamp_us;
+  record.type         = frame.type;
+  record.id           = frame.id;
+  record.data_len     = frame.data_len;
+  record.words        = 0;
+  for (size_t offset = 0;
+       record.words < MMWAVE_RECORD_WORDS && offset < data.size();
+       offset += sizeof(uint32_t)) {
+    record.value[record.words++].u = extractU32(data, offset);
+  }
+  record.truncated =
+      frame.truncated || data.size() > record.words * sizeof(uint32_t);
+}
+
+void SeeedmmWave::publishRecord(const MMWaveRecord& record) {
+  _records.push(record);
+  TaskHandle_t consumer = _record_consumer;
+  if (consumer) {
+    xTaskNotifyGive(consumer);
+  }
+}
+
+void SeeedmmWave::rxTask(void* arg) {
+  SeeedmmWave* self = static_cast<SeeedmmWave*>(arg);
+  // Published before anything is processed: at a higher priority than the
+  // caller the task runs before xTaskCreate() returns, and until then
+  // ownsReceivePath() would let other tasks read too and no record would
+  // be announced
+  self->_rx_task = xTaskGetCurrentTaskHandle();
+  while (!self->_rx_task_stop) {
+    // Wake up regularly even without data to time out pending commands
+    self->fetch(100);
+    self->processQueuedFrames();
+    self->expireCommands();
+  }
+  self->_rx_task = nullptr;
+  vTaskDelete(nullptr);
+}
+
+bool SeeedmmWave::startRxTask(UBaseType_t priority, uint32_t stack_size) {
+  if (_rx_task)
+    return true;
+  if (!_transport)
+    return false;
+
+  setFetchMode(FetchMode::EventDriven);
+  _rx_task_stop = false;
+  // Also published here, for a task of lower priority that has not run yet
+  TaskHandle_t task = nullptr;
+  if (xTaskCreate(rxTask, "mmwave_rx", stack_size, this, priority, &task) !=
+      pdPASS) {
+    return false;
+  }
+  _rx_task = task;
+  return true;
+}
+
+void SeeedmmWave::stopRxTask() {
+  if (!_rx_task)
+    return;
+  _rx_task_stop = true;
+  if (_rx_event) {
+    xSemaphoreGive(_rx_event);
+  }
+  while (_rx_task) {
+    vTaskDelay(1);
+  }
+}
+
+bool SeeedmmWave::readRecord(MMWaveRecord& record, uint32_t timeout) {
+  // Registered before looking at the ring so a record pushed in between
+  // leaves a pending notification instead of being missed
+  _record_consumer = xTaskGetCurrentTaskHandle();
+  if (_records.pop(record))
+    return true;
+
+  uint32_t expire_time = millis() + timeout;
+  for (;;) {
+    int32_t remaining = (int32_t)(expire_time - millis());
+    if (remaining <= 0)
+      return false;
+    TickType_t ticks = pdMS_TO_TICKS(remaining);
+    ulTaskNotifyTake(pdTRUE, ticks ? ticks : 1);
+    if (_records.pop(record))
+      return true;
+  }
+}
+
+void SeeedmmWave::notifySubscribers(const MMWaveRecord& record) {
+  for (size_t i = 0; i < _subscription_count; i++) {
+    const Subscription& sub = _subscriptions[i];
+    if (sub.handler &&
+        (sub.type == MMWAVE_ANY_TYPE || sub.type == record.type)) {
+      sub.handler(record, sub.ctx);
+    }
+  }
+}
+
+int SeeedmmWave::subscribe(uint16_t type, MMWaveHandler handler, void* ctx) {
+  if (!handler)
+    return -1;
+  // Reuse a slot released by unsubscribe() before growing the table
+  for (size_t i = 0; i < _subscription_count; i++) {
+    if (!_subscriptions[i].handler) {
+      _subscriptions[i] = {handler, ctx, type};
+      return i;
+    }
+  }
+  if (_subscription_count == MMWAVE_MAX_SUBSCRIPTIONS)
+    return -1;
+  _subscriptions[_subscription_count] = {handler, ctx, type};
+  return _subscription_count++;
+}
+
+bool SeeedmmWave::unsubscribe(int id) {
+  if (id < 0 || size_t(id) >= _subscription_count ||
+      !_subscriptions[id].handler)
+    return false;
+  _subscriptions[id].handler = nullptr;
+  return true;
+}
+
+int32_t SeeedmmWave::sendCommand(uint16_t type, const uint8_t* data,
+                                 size_t data_len,
+                                 MMWaveCommandCallback callback, void* ctx,
+                                 uint32_t timeout) {
+  // Register before sending so that even an immediate response finds it
+  PendingCommand* command = nullptr;
+  portENTER_CRITICAL(&_command_lock);
+  for (size_t i = 0; i < MMWAVE_MAX_PENDING_COMMANDS && !command; i++) {
+    if (!_commands[i].used)
+      command = &_commands[i];
+  }
+  // Then reuse a completed command whose status was never collected
+  for (size_t i = 0; i < MMWAVE_MAX_PENDING_COMMANDS && !command; i++) {
+    if (_commands[i].status != MMWaveCommandStatus::Pending)
+      command = &_commands[i];
+  }
+  uint16_t id = nextTxId();
+  if (command) {
+    command->callback = callback;
+    command->ctx      = ctx;
+    command->deadline = millis() + timeout;
+    command->id       = id;
+    command->type     = type;
+    command->status   = MMWaveCommandStatus::Pending;
+    command->used     = true;
+    _pending_commands++;
+  }
+  portEXIT_CRITICAL(&_command_lock);
+  if (!command)
+    return -1;
+
+  if (_transport && queueFrame(type, id, data, data_len, nullptr)) {
+    kickTx();
+  } else {
+    portENTER_CRITICAL(&_command_lock);
+    if (command->used && command->id == id &&
+        command->status == MMWaveCommandStatus::Pending) {
+      finishCommand(*command, MMWaveCommandStatus::SendFailed, nullptr);
+    }
+    portEXIT_CRITICAL(&_command_lock);
+  }
+  return id;
+}
+
+/**
+ * @brief Record the final status of a command. Called with the lock held;
+ * the callback itself runs once the lock is released.
+ */
+void SeeedmmWave::finishCommand(PendingCommand& command,
+                                MMWaveCommandStatus status,
+                                const MMWaveRecord* response) {
+  MMWaveCommandCallback callback = command.callback;
+  void* ctx                      = command.ctx;
+  uint16_t id                    = command.id;
+
+  command.status = status;
+  _pending_commands--;
+  if (callback) {
+    command.used = false;
+    portEXIT_CRITICAL(&_command_lock);
+    callback(id, status, response, ctx);
+    portENTER_CRITICAL(&_command_lock);
+  }
+}
+
+void SeeedmmWave::completeCommand(const MMWaveRecord& record) {
+  portENTER_CRITICAL(&_command_lock);
+  PendingCommand* match = nullptr;
+  for (size_t i = 0; i < MMWAVE_MAX_PENDING_COMMANDS; i++) {
+    PendingCommand& command = _commands[i];
+    if (!command.used || command.status != MMWaveCommandStatus::Pending ||
+        command.type != record.type)
+      continue;
+    if (command.id == record.id) {
+      match = &command;
+      break;
+    }
+    // Fall back on the oldest command of the type
+    if (!match || (int16_t)(command.id - match->id) < 0)
+      match = &command;
+  }
+  if (match) {
+    finishCommand(*match, MMWaveCommandStatus::Acked, &record);
+  }
+  portEXIT_CRITICAL(&_command_lock);
+}
+
+bool SeeedmmWave::isCommandId(uint16_t id, void* arg) {
+  SeeedmmWave* self = static_cast<SeeedmmWave*>(arg);
+  if (!self->_pending_commands)
+    return false;
+  bool found = false;
+  portENTER_CRITICAL(&self->_command_lock);
+  for (size_t i = 0; i < MMWAVE_MAX_PENDING_COMMANDS && !found; i++) {
+    const PendingCommand& command = self->_commands[i];
+    found = command.used && command.status == MMWaveCommandStatus::Pending &&
+            command.id == id;
+  }
+  portEXIT_CRITICAL(&self->_command_lock);
+  return found;
+}
+
+void SeeedmmWave::expireCommands() {
+  if (!_pending_commands)
+    return;
+  uint32_t now = millis();
+  portENTER_CRITICAL(&_command_lock);
+  for (size_t i = 0; i < MMWAVE_MAX_PENDING_COMMANDS; i++) {
+    PendingCommand& command = _commands[i];
+    if (command.used && command.status == MMWaveCommandStatus::Pending &&
+        (int32_t)(now - command.deadline) >= 0) {
+      finishCommand(command, MMWaveCommandStatus::Timeout, nullptr);
+    }
+  }
+  portEXIT_CRITICAL(&_command_lock);
+}
+
+MMWaveCommandStatus SeeedmmWave::getCommandStatus(uint16_t id) {
+  MMWaveCommandStatus status = MMWaveCommandStatus::Unknown;
+  portENTER_CRITICAL(&_command_lock);
+  for (size_t i = 0; i < MMWAVE_MAX_PENDING_COMMANDS; i++) {
+    PendingCommand& command = _commands[i];
+    if (command.used && command.id == id) {
+      status = command.status;
+      if (status != MMWaveCommandStatus::Pending)
+        command.used = false;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&_command_lock);
+  return status;
+}
+
+MMWaveCommandStatus SeeedmmWave::waitCommand(uint16_t id) {
+  for (;;) {
+    MMWaveCommandStatus status = getCommandStatus(id);
+    if (status != MMWaveCommandStatus::Pending)
+      return status;
+    // Called while handling a frame: waiting could never end
+    if (_processing == xTaskGetCurrentTaskHandle())
+      return status;
+    if (ownsReceivePath()) {
+      fetch(_fetch_mode == FetchMode::EventDriven ? 100 : 10);
+      processQueuedFrames();
+      expireCommands();
+    } else {
+      vTaskDelay(1);
+    }
+  }
+}
+
+#if MMWAVE_DIAG_METRICS
+// Key suffix and label of each metric, in the order reportMetrics() fills
+// in the values
+static const struct {
+  const char* name;
+  const char* label;
+} kMetrics[MMWAVE_METRICS_COUNT] = {
+    {"bytes", "Bytes received"},
+    {"frames", "Frames queued"},
+    {"hdr_err", "Header checksum errors"},
+    {"data_err", "Data checksum errors"},
+    {"oversize", "Oversize frames dropped"},
+    {"evicted", "Queued frames evicted"},
+    {"overflow", "Frames dropped when full"},
+    {"id_gaps", "Frame ID gaps"},
+    {"id_miss", "Frame IDs missed"},
+    {"cyc_min", "Min cycles per frame"},
+    {"cyc_avg", "Avg cycles per frame"},
+    {"cyc_max", "Max cycles per frame"},
+};
+
+bool SeeedmmWave::registerMetrics(const char* tag) {
+  if (_metrics_tag || strlen(tag) > MMWAVE_METRICS_TAG_MAX)
+    return false;
+  for (size_t i = 0; i < MMWAVE_METRICS_COUNT; i++) {
+    snprintf(_metrics_keys[i], sizeof(_metrics_keys[i]), "%s_%s", tag,
+             kMetrics[i].name);
+    if (esp_diag_metrics_register(tag, _metrics_keys[i], kMetrics[i].label,
+                                  "mmwave", ESP_DIAG_DATA_TYPE_UINT) !=
+        ESP_OK) {
+      while (i--) {
+#  if CONFIG_ESP_INSIGHTS_META_VERSION_10
+        esp_diag_metrics_unregister(_metrics_keys[i]);
+#  else
+        esp_diag_metrics_unregister(tag, _metrics_keys[i]);
+#  endif
+      }
+      return false;
+    }
+  }
+  _metrics_tag = tag;
+  return true;
+}
+
+bool SeeedmmWave::reportMetrics() {
+  if (!_metrics_tag)
+    return false;
+
+  const MMWaveParserStats& parser = _parser.parserStats();
+  uint32_t dispatched = 0;
+  uint64_t cycles     = 0;
+  uint32_t cycles_min = 0;
+  uint32_t cycles_max = 0;
+  for (const FetchStats& stats : _fetch_stats) {
+    if (stats.dispatched == 0)
+      continue;
+    if (dispatched == 0 || stats.dispatch_cycles_min < cycles_min)
+      cycles_min = stats.dispatch_cycles_min;
+    if (stats.dispatch_cycles_max > cycles_max)
+      cycles_max = stats.dispatch_cycles_max;
+    dispatched += stats.dispatched;
+    cycles += stats.dispatch_cycles;
+  }
+
+  const uint32_t values[MMWAVE_METRICS_COUNT] = {
+      uint32_t(parser.bytes),
+      parser.frames,
+      parser.header_errors,
+      parser.data_errors,
+      parser.oversize,
+      parser.evicted,
+      parser.overflowed,
+      parser.id_gaps,
+      parser.ids_missed,
+      cycles_min,
+      dispatched ? uint32_t(cycles / dispatched) : 0,
+      cycles_max,
+  };
+  bool ok = true;
+  for (size_t i = 0; i < MMWAVE_METRICS_COUNT; i++) {
+#  if CONFIG_ESP_INSIGHTS_META_VERSION_10
+    esp_err_t err = esp_diag_metrics_add_uint(_metrics_keys[i], values[i]);
+#  else
+    esp_err_t err =
+        esp_diag_metrics_report_uint(_metrics_tag, _metrics_keys[i], values[i]);
+#  endif
+    if (err != ESP_OK)
+      ok = false;
+  }
+  return ok;
+}
+#endif
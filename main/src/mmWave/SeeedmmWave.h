@@ -14,12 +14,20 @@
 // Code for version 1.x
 #endif
 
-#ifndef ESP32
+// MMWAVE_HOST builds the library for a Linux host, see host/
+#if !defined(ESP32) && !defined(MMWAVE_HOST)
 #  error "Currently this library only supports ESP32"
 #endif
 
+#include <atomic>
+#include <initializer_list>
 #include <memory>
-#include <queue>
+#include <vector>
+
+#include "esp_cpu.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 
 #ifndef _MMWAVE_DEBUG
   #define _MMWAVE_DEBUG 0
@@ -32,18 +40,11 @@
 #endif
 
 #define MAX_QUEUE_SIZE    10
-#define FRAME_BUFFER_SIZE 512
-#define SOF_BYTE          0x01
-
-// Frame structure sizes
-#define SIZE_SOF        1
-#define SIZE_ID         2
-#define SIZE_LEN        2
-#define SIZE_TYPE       2
-#define SIZE_HEAD_CKSUM 1
-#define SIZE_FRAME_HEADER                                                      \
-  (SIZE_SOF + SIZE_ID + SIZE_LEN + SIZE_TYPE + SIZE_HEAD_CKSUM)
-#define SIZE_DATA_CKSUM 1
+
+#include "SeeedmmWaveCodec.h"
+#include "SeeedmmWaveParser.h"
+#include "SeeedmmWaveSpsc.h"
+#include "SeeedmmWaveTransport.h"
 
 #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
 #  define SEEED_WAVE_IS_BIG_ENDIAN 1
@@ -57,15 +58,268 @@
 
 #endif
 
-#define MMWaveMaxQueueSize 120
+/**
+ * @brief How fetch() waits for data from the sensor.
+ */
+enum class FetchMode : uint8_t {
+  Polling     = 0,  // spin on available() for the whole timeout
+  EventDriven = 1,  // sleep on UART RX events, return once a frame is queued
+};
+
+/**
+ * @brief CPU time accounting of fetch(), kept separately for each FetchMode.
+ *
+ * wall_us is the time spent inside fetch(), busy_us the part of it the task
+ * was actually running (not blocked waiting for a UART RX event).
+ * parse_cycles counts the CPU cycles spent reading and framing the bytes,
+ * dispatch_cycles those spent in handleType() for the dispatched frames,
+ * with the cheapest and the most expensive single frame alongside.
+ */
+typedef struct FetchStats {
+  uint32_t calls;
+  uint32_t frames;
+  uint64_t bytes;
+  uint64_t wall_us;
+  uint64_t busy_us;
+  uint64_t parse_cycles;
+  uint32_t dispatched;
+  uint64_t dispatch_cycles;
+  uint32_t dispatch_cycles_min;
+  uint32_t dispatch_cycles_max;
+} FetchStats;
+
+// The reception counters can be published as esp_diagnostics metrics
+#if defined(CONFIG_DIAG_ENABLE_METRICS) && CONFIG_DIAG_ENABLE_METRICS &&    \
+    __has_include("esp_diagnostics_metrics.h")
+#  define MMWAVE_DIAG_METRICS 1
+#else
+#  define MMWAVE_DIAG_METRICS 0
+#endif
+
+// Metrics registered per sensor by registerMetrics()
+#define MMWAVE_METRICS_COUNT 12
+
+// Longest registerMetrics() tag: the keys are the tag, '_' and a name of up
+// to 8 characters, and esp_diagnostics keeps 15
+#define MMWAVE_METRICS_TAG_MAX 6
+
+// Decoded records buffered between the RX task and the consumer task
+#ifndef MMWAVE_RECORD_RING_SIZE
+#  define MMWAVE_RECORD_RING_SIZE 64
+#endif
+
+// 32-bit payload words carried by a MMWaveRecord, enough for every fixed
+// size report; point clouds keep their target count and first target only
+#ifndef MMWAVE_RECORD_WORDS
+#  define MMWAVE_RECORD_WORDS 8
+#endif
+
+typedef union MMWaveValue {
+  float f;
+  uint32_t u;
+} MMWaveValue;
+
+/**
+ * @brief A decoded frame published by the RX task.
+ *
+ * The payload is decoded into native-endian 32-bit words, the last one
+ * zero-padded when the length is not a multiple of four (a one byte command
+ * acknowledgement is value[0].u); data_len is the payload length on the
+ * wire, which may be longer than the words kept. truncated is set when the
+ * words do not hold the whole payload, as for point clouds and target lists
+ * with more than one target, or when the frame itself was truncated; read
+ * those with the getters of the derived class instead.
+ * timestamp_us is the esp_timer time the SOF byte was received, see
+ * frameTimestamp() for its accuracy.
+ */
+typedef struct MMWaveRecord {
+  int64_t timestamp_us;
+  uint16_t type;
+  uint16_t id;
+  uint16_t data_len;
+  uint8_t words;
+  bool truncated;
+  MMWaveValue value[MMWAVE_RECORD_WORDS];
+} MMWaveRecord;
+
+// Bytes per target in the point cloud reports: x, y, doppler, cluster
+#define MMWAVE_POINT_SIZE 16
+
+// Targets kept from one point cloud report, enough for the largest payload
+// that is queued whole
+#ifndef MMWAVE_POINT_CLOUD_CAPACITY
+#  define MMWAVE_POINT_CLOUD_CAPACITY                                          \
+    ((MMWAVE_MAX_PAYLOAD - sizeof(uint32_t)) / MMWAVE_POINT_SIZE)
+#endif
+
+/**
+ * @brief Decoded point cloud or target list, one array per field.
+ *
+ * Fixed capacity and contiguous per field so that clustering and tracking
+ * can run over plain float arrays with no allocation per frame.
+ */
+typedef struct MMWavePointCloud {
+  int64_t timestamp_us;  // esp_timer time the frame was received
+  uint32_t count;
+  float x[MMWAVE_POINT_CLOUD_CAPACITY];
+  float y[MMWAVE_POINT_CLOUD_CAPACITY];
+  int32_t dop[MMWAVE_POINT_CLOUD_CAPACITY];
+  int32_t cluster[MMWAVE_POINT_CLOUD_CAPACITY];
+} MMWavePointCloud;
+
+// Payload layouts shared by the devices
+typedef MMWavePayload<uint8_t, uint8_t> MMWaveFlagPayload;  // flags, acks
+typedef MMWavePayload<float, float> MMWaveFloatPayload;
+typedef MMWavePayload<uint32_t, uint32_t> MMWaveU32Payload;
+typedef MMWaveRawPayload<sizeof(uint32_t)> MMWavePointCloudPayload;
+
+/**
+ * @brief Callback invoked for every processed frame of a subscribed type.
+ *
+ * Runs in the task that processes frames (the RX task when it is started),
+ * so it should be short and must not block.
+ */
+typedef void (*MMWaveHandler)(const MMWaveRecord& record, void* ctx);
+
+// Maximum number of simultaneous subscriptions per sensor
+#ifndef MMWAVE_MAX_SUBSCRIPTIONS
+#  define MMWAVE_MAX_SUBSCRIPTIONS 8
+#endif
+
+// Subscription type matching every frame type
+#define MMWAVE_ANY_TYPE 0xFFFF
+
+// Outgoing frames waiting for room in the UART TX buffer
+#ifndef MMWAVE_TX_QUEUE_SIZE
+#  define MMWAVE_TX_QUEUE_SIZE 4
+#endif
+
+// Largest command payload; the longest one sent today is the 16 byte alarm
+// area
+#ifndef MMWAVE_TX_MAX_PAYLOAD
+#  define MMWAVE_TX_MAX_PAYLOAD 32
+#endif
+
+#define MMWAVE_TX_FRAME_SIZE                                                   \
+  (SIZE_FRAME_HEADER + MMWAVE_TX_MAX_PAYLOAD + SIZE_DATA_CKSUM)
+
+/**
+ * @brief State of a command sent with sendCommand().
+ */
+enum class MMWaveCommandStatus : uint8_t {
+  Pending,     // waiting for the response frame
+  Acked,       // the response frame was received
+  Timeout,     // no response before the deadline
+  SendFailed,  // the frame could not be written to the UART
+  Unknown,     // no such command, or its status was already collected
+};
+
+/**
+ * @brief Called once when a command completes.
+ *
+ * response is the decoded response frame, nullptr unless status is Acked.
+ * Runs in the task processing frames, like MMWaveHandler.
+ */
+typedef void (*MMWaveCommandCallback)(uint16_t id, MMWaveCommandStatus status,
+                                      const MMWaveRecord* response, void* ctx);
+
+// Commands that can await their response at the same time
+#ifndef MMWAVE_MAX_PENDING_COMMANDS
+#  define MMWAVE_MAX_PENDING_COMMANDS 4
+#endif
 
 class SeeedmmWave {
  private:
-  HardwareSerial* _serial;
+  SeeedmmWaveTransport* _transport = nullptr;
+#ifndef MMWAVE_HOST
+  SeeedmmWaveSerialTransport _serial_transport;
+#endif
   uint32_t _baud;
   uint32_t _wait_delay;
 
-  std::queue<std::vector<uint8_t>> byteQueue;
+  // Receive and transmit state is per instance so that several sensors can
+  // be driven from different tasks without sharing anything
+  SeeedmmWaveParser _parser;
+  std::atomic<uint16_t> _tx_id{0x8000};
+
+  // Frames are built in place in the TX queue by any task and written out by
+  // the task owning the receive path, as fast as the UART TX buffer allows
+  typedef struct TxFrame {
+    uint8_t bytes[MMWAVE_TX_FRAME_SIZE];
+    uint8_t len;
+  } TxFrame;
+  TxFrame _tx_queue[MMWAVE_TX_QUEUE_SIZE];
+  std::atomic<uint32_t> _tx_head{0};
+  std::atomic<uint32_t> _tx_tail{0};
+  size_t _tx_pos        = 0;  // bytes of the front frame already written
+  portMUX_TYPE _tx_lock = portMUX_INITIALIZER_UNLOCKED;
+
+  // Arrival time of the frame being handled, see frameTimestamp()
+  int64_t _frame_timestamp_us = 0;
+
+  FetchMode _fetch_mode = FetchMode::Polling;
+  FetchStats _fetch_stats[2] = {};
+  SemaphoreHandle_t _rx_event = nullptr;
+  StaticSemaphore_t _rx_event_buffer;
+  bool _rx_event_attached = false;  // the transport signals arrivals
+
+  // Optional RX task publishing decoded records to one consumer task
+  volatile TaskHandle_t _rx_task         = nullptr;
+  volatile bool _rx_task_stop            = false;
+  volatile TaskHandle_t _record_consumer = nullptr;
+  SeeedmmWaveSpscRing<MMWaveRecord, MMWAVE_RECORD_RING_SIZE> _records;
+
+  // Task inside processFramesWith(), whose handlers must not process frames
+  // again: the frame being handled is still pinned at the front of the queue
+  volatile TaskHandle_t _processing = nullptr;
+
+  void attachRxEvent();
+  static void signalRxEvent(void* arg);
+  size_t drainSerial();
+  bool ownsReceivePath() const;
+  bool queueFrame(uint16_t type, uint16_t id, const uint8_t* data,
+                  size_t data_len, uint32_t* ticket);
+  void kickTx();
+  void pumpTx();
+  typedef struct Subscription {
+    MMWaveHandler handler;
+    void* ctx;
+    uint16_t type;
+  } Subscription;
+  Subscription _subscriptions[MMWAVE_MAX_SUBSCRIPTIONS] = {};
+  size_t _subscription_count                            = 0;
+
+  // Commands in flight, matched to their response by frame ID. The table is
+  // shared between the sending task and the one processing frames.
+  typedef struct PendingCommand {
+    MMWaveCommandCallback callback;
+    void* ctx;
+    uint32_t deadline;  // millis()
+    uint16_t id;
+    uint16_t type;
+    MMWaveCommandStatus status;
+    bool used;
+  } PendingCommand;
+  PendingCommand _commands[MMWAVE_MAX_PENDING_COMMANDS] = {};
+  std::atomic<uint8_t> _pending_commands{0};
+  portMUX_TYPE _command_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if MMWAVE_DIAG_METRICS
+  const char* _metrics_tag = nullptr;
+  char _metrics_keys[MMWAVE_METRICS_COUNT][16];
+#endif
+
+  void completeCommand(const MMWaveRecord& record);
+  static bool isCommandId(uint16_t id, void* arg);
+  void expireCommands();
+  void finishCommand(PendingCommand& command, MMWaveCommandStatus status,
+                     const MMWaveRecord* response);
+
+  void decodeRecord(const MMWaveFrame& frame, const MMWaveFrameView& data,
+                    MMWaveRecord& record) const;
+  void publishRecord(const MMWaveRecord& record);
+  void notifySubscribers(const MMWaveRecord& record);
+  static void rxTask(void* arg);
 
  protected:
   size_t expectedFrameLength(const std::vector<uint8_t>& buffer);
@@ -74,11 +328,28 @@ class SeeedmmWave {
                         uint8_t expected_checksum);
   float extractFloat(const uint8_t* bytes) const;
   uint32_t extractU32(const uint8_t* bytes) const;
+  float extractFloat(const MMWaveFrameView& data, size_t offset) const;
+  uint32_t extractU32(const MMWaveFrameView& data, size_t offset) const;
   void floatToBytes(float value, uint8_t* bytes);
   void uint32ToBytes(uint32_t value, uint8_t* bytes);
 
   bool processFrame(const uint8_t* frame_bytes, size_t len,
                     uint16_t data_type = 0xFFFF);
+
+  /**
+   * @brief Body of processQueuedFrames(), with the frame handler supplied by
+   * the caller.
+   *
+   * handle(type, payload) is called for every frame of the requested type.
+   * The base class passes the virtual handleType(); SeeedmmWaveT passes a
+   * direct call to the device decoder, which lets the compiler inline and
+   * specialise it in this loop.
+   */
+  template <typename Handler>
+  bool processFramesWith(uint16_t data_type, uint32_t timeout,
+                         Handler&& handle);
+  bool dispatchFrame(uint16_t type, const MMWaveFrameView& data,
+                     uint16_t data_type = 0xFFFF);
   /**
    * @brief Handle different types of data frames.
    *
@@ -94,21 +365,74 @@ class SeeedmmWave {
   virtual bool handleType(uint16_t _type, const uint8_t* data,
                           size_t data_len) = 0;
 
-  std::vector<uint8_t> packetFrame(uint16_t type, const uint8_t* data = nullptr,
-                                   size_t len = 0);
-  bool sendFrame(const std::vector<uint8_t>& frame);
+  /**
+   * @brief Handle a data frame read in place from the receive ring.
+   *
+   * The payload may wrap around the end of the ring. The default
+   * implementation forwards contiguous payloads to the pointer overload and
+   * linearizes the rare wrapped ones on the stack; derived classes can
+   * override it to decode straight from the view without any copy.
+   *
+   * @param _type The type of the data frame.
+   * @param data The view of the payload, valid until this call returns.
+   * @return true if the data is processed successfully, false otherwise.
+   */
+  virtual bool handleType(uint16_t _type, const MMWaveFrameView& data);
+
+  /**
+   * @brief esp_timer time, in microseconds, at which the SOF byte of the
+   * frame being handled was received. Valid inside handleType().
+   *
+   * Derived from SeeedmmWaveTransport::receiveTime() of the read that
+   * delivered the frame's last bytes, back-dated by their time on the wire.
+   * Over SeeedmmWaveSerialTransport it is the time of the UART receive event,
+   * so it is accurate however late fetch() runs; a transport without receive
+   * times only gives the time of the read, and intervals and jitter then
+   * measure the application loop unless the RX task, or a loop calling
+   * update() continuously, drains the port as bytes arrive.
+   */
+  int64_t frameTimestamp() const {
+    return _frame_timestamp_us;
+  }
+
+  bool decodePointCloud(const MMWaveFrameView& data,
+                        MMWavePointCloud& cloud) const;
+
+  /**
+   * @brief Write a frame into a caller provided buffer.
+   *
+   * @param frame At least SIZE_FRAME_HEADER + len + SIZE_DATA_CKSUM bytes.
+   * @return The length of the frame.
+   */
+  size_t packetFrame(uint16_t type, uint16_t id, const uint8_t* data,
+                     size_t len, uint8_t* frame);
+  uint16_t nextTxId() {
+    return _tx_id.fetch_add(1, std::memory_order_relaxed);
+  }
 
  public:
   SeeedmmWave() {}
   virtual ~SeeedmmWave() {
-    if (_serial) {
-      _serial->end();
-      _serial = nullptr;
+    if (_transport) {
+      _transport->end();
+      _transport = nullptr;
     }
   }
 
-  void begin(HardwareSerial* serial, uint32_t baud = _UART_BAUD,
+  /**
+   * @brief Start talking to the sensor over any byte stream.
+   *
+   * @param transport Must outlive the sensor object.
+   */
+  void begin(SeeedmmWaveTransport* transport, uint32_t baud = _UART_BAUD,
              uint32_t wait_delay = 1, int rst = -1);
+#ifndef MMWAVE_HOST
+  void begin(HardwareSerial* serial, uint32_t baud = _UART_BAUD,
+             uint32_t wait_delay = 1, int rst = -1) {
+    _serial_transport.attach(serial);
+    begin(&_serial_transport, baud, wait_delay, rst);
+  }
+#endif
   int available();
   int read(void);
   int read(char* data, int length);
@@ -132,11 +456,316 @@ class SeeedmmWave {
   bool fetchType(uint16_t data_type = 0xFFFF, uint32_t timeout = 1000);
   bool send(uint16_t type, const uint8_t* data = nullptr, size_t data_len = 0);
 
-  bool processQueuedFrames(uint16_t data_type = 0xFFFF,
-                           uint32_t timeout   = 1000);
+  /**
+   * @brief Queue a frame for transmission and return immediately.
+   *
+   * The frame is built without any heap allocation straight into the TX
+   * queue. It is written to the UART from this call, fetch() and update(),
+   * or by the RX task when it runs, only as far as the TX buffer has room,
+   * so a send never blocks on the UART draining.
+   *
+   * @param ticket Optional, set to a value to pass to isSent().
+   * @retval false The payload is longer than MMWAVE_TX_MAX_PAYLOAD or the TX
+   * queue is full.
+   */
+  bool sendAsync(uint16_t type, const uint8_t* data = nullptr,
+                 size_t data_len = 0, uint32_t* ticket = nullptr);
+
+  /**
+   * @brief Whether a queued frame has been handed to the UART driver.
+   */
+  bool isSent(uint32_t ticket) const {
+    return (int32_t)(_tx_tail.load(std::memory_order_acquire) - ticket) > 0;
+  }
+
+  /**
+   * @brief Wait until every queued frame has been handed to the UART driver.
+   *
+   * @retval false Frames are still queued after timeout milliseconds.
+   */
+  bool flushTx(uint32_t timeout = 100);
+
+  /**
+   * @brief Send a command frame without waiting for its response.
+   *
+   * The response is recognised by the frame ID written by packetFrame(), or,
+   * for firmware that does not echo it, by being the oldest command of the
+   * same type. Report frames keep being processed while the command is in
+   * flight. Completion is reported to the callback if one is given, else it
+   * is collected with getCommandStatus() or waitCommand().
+   *
+   * @param timeout Milliseconds to wait for the response.
+   * @return The frame ID of the command, -1 when the command table is full.
+   */
+  int32_t sendCommand(uint16_t type, const uint8_t* data = nullptr,
+                      size_t data_len = 0,
+                      MMWaveCommandCallback callback = nullptr,
+                      void* ctx = nullptr, uint32_t timeout = 1000);
+
+  /**
+   * @brief Status of a command sent without a callback.
+   *
+   * Once a final status has been returned the command is forgotten and
+   * further calls return MMWaveCommandStatus::Unknown.
+   */
+  MMWaveCommandStatus getCommandStatus(uint16_t id);
+
+  /**
+   * @brief Block until a command sent without a callback completes.
+   *
+   * Frames keep being received and handled meanwhile, by this task or by
+   * the RX task when it runs.
+   *
+   * @attention Not from handleType(), a subscriber or a command callback:
+   * the response could only be handled by the very frame loop that is
+   * waiting. There the call returns MMWaveCommandStatus::Pending at once;
+   * use a command callback or getCommandStatus() instead.
+   */
+  MMWaveCommandStatus waitCommand(uint16_t id);
+
+  /**
+   * @brief Handle the frames received by fetch().
+   *
+   * Virtual so that a front end can replace the per-frame dispatch; it is
+   * called once per batch of frames, never per frame.
+   */
+  virtual bool processQueuedFrames(uint16_t data_type = 0xFFFF,
+                                   uint32_t timeout   = 1000);
+
+  void setFetchMode(FetchMode mode);
+  FetchMode getFetchMode() const {
+    return _fetch_mode;
+  }
+  const FetchStats& getFetchStats(FetchMode mode) const {
+    return _fetch_stats[static_cast<uint8_t>(mode)];
+  }
+  void resetFetchStats();
+
+  /**
+   * @brief Call a handler for every processed frame of a type.
+   *
+   * The handler receives the decoded record as soon as processQueuedFrames()
+   * (or the RX task) handles the frame, independently of the destructive
+   * getters of the derived class, so every consumer sees every sample.
+   * Subscribe before starting the RX task; the table is not locked.
+   *
+   * A record only keeps MMWAVE_RECORD_WORDS words of payload: variable
+   * length reports such as point clouds arrive with record.truncated set,
+   * their target count and first target only.
+   *
+   * @param type The frame type, or MMWAVE_ANY_TYPE for all frames.
+   * @param handler The callback.
+   * @param ctx Passed back to the callback.
+   * @return A subscription id for unsubscribe(), -1 when the table is full.
+   */
+  int subscribe(uint16_t type, MMWaveHandler handler, void* ctx = nullptr);
+  template <typename T>
+  int subscribe(T type, MMWaveHandler handler, void* ctx = nullptr) {
+    return subscribe(static_cast<uint16_t>(type), handler, ctx);
+  }
+  bool unsubscribe(int id);
+
+  /**
+   * @brief Run reception in a dedicated FreeRTOS task.
+   *
+   * The task sleeps on UART RX events, decodes every frame through
+   * handleType() as soon as it arrives and publishes a MMWaveRecord for it
+   * into a lock-free SPSC ring drained with readRecord(). While it runs,
+   * ingestion never waits behind application code, and update(), fetch()
+   * and fetchType() called from any other task return without touching the
+   * receive path.
+   *
+   * @param priority FreeRTOS priority of the RX task.
+   * @param stack_size Stack size of the RX task in bytes.
+   * @retval true The task is running.
+   */
+  bool startRxTask(UBaseType_t priority = configMAX_PRIORITIES - 2,
+                   uint32_t stack_size  = 4096);
+  void stopRxTask();
+  bool isRxTaskRunning() const {
+    return _rx_task != nullptr;
+  }
+
+  /**
+   * @brief Take the oldest record published by the RX task.
+   *
+   * Must always be called from the same task. When the ring is empty the
+   * caller sleeps on a task notification until a record arrives.
+   *
+   * @param record Filled with the record.
+   * @param timeout Maximum time to wait in milliseconds, 0 to poll.
+   * @retval true A record was returned.
+   */
+  bool readRecord(MMWaveRecord& record, uint32_t timeout = 0);
+  size_t getRecordHighWater() const {
+    return _records.highWater();
+  }
+  uint32_t getRecordsDropped() const {
+    return _records.dropped();
+  }
+
+  /**
+   * @brief Accepted, truncated and dropped frame counts per frame type.
+   *
+   * @param count Set to the number of entries in the returned table.
+   */
+  const MMWaveTypeStats* getTypeStats(size_t& count) const {
+    return _parser.typeStats(count);
+  }
+  void resetTypeStats() {
+    _parser.resetTypeStats();
+  }
+
+  /**
+   * @brief Bytes received, checksum failures, drops and frame ID gaps over
+   * the whole stream, see MMWaveParserStats.
+   */
+  const MMWaveParserStats& getParserStats() const {
+    return _parser.parserStats();
+  }
+  void resetParserStats() {
+    _parser.resetParserStats();
+  }
+
+#if MMWAVE_DIAG_METRICS
+  /**
+   * @brief Register the reception counters as esp_diagnostics metrics.
+   *
+   * Metrics must be initialised already, by esp_insights or with
+   * esp_diag_metrics_init(). The keys are the tag followed by the counter
+   * name, e.g. "mmwave_hdr_err", so that several sensors can be told apart.
+   *
+   * @param tag Up to MMWAVE_METRICS_TAG_MAX characters, must stay valid for
+   * as long as the metrics are registered.
+   * @retval false The tag is too long, metrics are not initialised, or the
+   * metrics table (CONFIG_DIAG_METRICS_MAX_COUNT) is full.
+   */
+  bool registerMetrics(const char* tag = "mmwave");
 
+  /**
+   * @brief Report the counters of getParserStats() and the dispatch cycles
+   * of both fetch modes. Call periodically, from any task.
+   *
+   * Values are reported as uint32, the byte count wrapping around. Counters
+   * updated by the RX task meanwhile may be a frame apart.
+   */
+  bool reportMetrics();
+#endif
+
+  /**
+   * @brief Only buffer and handle frames of the given types.
+   *
+   * Other frames are skipped in the byte stream right after their header
+   * checksum, without being checksummed, queued or handled, and counted as
+   * skipped in getTypeStats(). Responses to commands are frames like any
+   * other: keep the types of the commands sent in the list. Set the mask
+   * before starting the RX task; it is not locked.
+   *
+   * @param count 0 to accept every type again.
+   * @retval false More than MMWAVE_ACCEPT_TYPES_SIZE types.
+   */
+  bool setAcceptedTypes(const uint16_t* types, size_t count) {
+    return _parser.setAcceptedTypes(types, count);
+  }
+  template <typename T>
+  bool setAcceptedTypes(std::initializer_list<T> types) {
+    uint16_t list[MMWAVE_ACCEPT_TYPES_SIZE];
+    if (types.size() > MMWAVE_ACCEPT_TYPES_SIZE)
+      return false;
+    size_t count = 0;
+    for (T type : types) {
+      list[count++] = static_cast<uint16_t>(type);
+    }
+    return setAcceptedTypes(list, count);
+  }
+  void acceptAllTypes() {
+    _parser.setAcceptedTypes(nullptr, 0);
+  }
+
+  /**
+   * @brief Choose how the frames of a type wait between fetch() and their
+   * handling.
+   *
+   * LatestOnly keeps a single, newest frame of the type queued, so a slow
+   * consumer never works through stale reports. When the queue is full the
+   * oldest frame of the lowest priority makes room, and DropWhenFull frames
+   * never do; see MMWaveQueueRule. Set the policies before starting the RX
+   * task; the table is not locked.
+   *
+   * @param priority Higher is evicted last.
+   * @retval false MMWAVE_QUEUE_RULES_SIZE types already have a policy.
+   */
+  bool setQueuePolicy(uint16_t type, MMWaveQueuePolicy policy,
+                      uint8_t priority = 0) {
+    return _parser.setQueueRule(type, policy, priority);
+  }
+  template <typename T>
+  bool setQueuePolicy(T type, MMWaveQueuePolicy policy,
+                      uint8_t priority = 0) {
+    return setQueuePolicy(static_cast<uint16_t>(type), policy, priority);
+  }
 };
 
+void printHexBuff(const uint8_t* buffer, size_t len);
 void printHexBuff(const std::vector<uint8_t>& buffer);
 
+template <typename Handler>
+bool SeeedmmWave::processFramesWith(uint16_t data_type, uint32_t timeout,
+                                    Handler&& handle) {
+  bool result = false;
+
+  // Also refuses a handler calling update() or processQueuedFrames()
+  if (_parser.empty() || !ownsReceivePath() ||
+      _processing == xTaskGetCurrentTaskHandle()) {
+    return false;
+  }
+
+  FetchStats& stats = _fetch_stats[static_cast<uint8_t>(_fetch_mode)];
+  _processing       = xTaskGetCurrentTaskHandle();
+  do {
+    // front() pins the frame in the receive ring until pop()
+    const MMWaveFrame& frame = _parser.front();
+#if _MMWAVE_DEBUG == 1
+    MMWaveFrameView bytes = _parser.bytes(frame);
+    uint8_t linear[FRAME_BUFFER_SIZE];
+    printHexBuff(linear, bytes.copy(linear, 0, bytes.size()));
+#endif
+    // The parser only queues frames whose checksums already matched
+    MMWaveFrameView payload = _parser.payload(frame);
+    _frame_timestamp_us     = frame.timestamp_us;
+    // Only proceed if the type matches or if data_type is set to the
+    // default, indicating no specific type is required
+    if (data_type == 0xFFFF || data_type == frame.type) {
+      uint32_t cycles = esp_cpu_get_cycle_count();
+      if (handle(frame.type, payload)) {
+        result = true;
+      }
+      cycles = esp_cpu_get_cycle_count() - cycles;
+      if (stats.dispatched == 0 || cycles < stats.dispatch_cycles_min) {
+        stats.dispatch_cycles_min = cycles;
+      }
+      if (cycles > stats.dispatch_cycles_max) {
+        stats.dispatch_cycles_max = cycles;
+      }
+      stats.dispatch_cycles += cycles;
+      stats.dispatched++;
+    }
+    if (_rx_task || _subscription_count || _pending_commands) {
+      MMWaveRecord record;
+      decodeRecord(frame, payload, record);
+      if (_pending_commands) {
+        completeCommand(record);
+      }
+      notifySubscribers(record);
+      if (_rx_task) {
+        publishRecord(record);
+      }
+    }
+    _parser.pop();
+  } while (!_parser.empty() && timeout);
+  _processing = nullptr;
+
+  return result;
+}
+
 #endif  // SEEEDMMWAVE_H
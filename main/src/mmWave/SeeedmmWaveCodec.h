@@ -0,0 +1,184 @@
+/**
+ * @file SeeedmmWaveCodec.h
+ *
+ * @note Wire codec for the payload of Seeed mmWave frames.
+ *
+ * Payload fields are little-endian 8, 16 or 32-bit scalars packed without
+ * padding, so they sit at arbitrary alignment in the receive ring. Values
+ * are loaded with memcpy into a register-sized integer, which the compiler
+ * turns into the best load the target allows, byte swapped only when the
+ * host is big-endian; the choice is made at compile time.
+ */
+
+#ifndef SEEEDMMWAVE_CODEC_H
+#define SEEEDMMWAVE_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <bit>
+#include <type_traits>
+#include <utility>
+
+#include "SeeedmmWaveParser.h"
+
+// Unsigned integer of each field size, and how to byte swap it
+template <size_t N>
+struct MMWaveWireWord;
+template <>
+struct MMWaveWireWord<1> {
+  typedef uint8_t type;
+  static constexpr uint8_t swap(uint8_t v) {
+    return v;
+  }
+};
+template <>
+struct MMWaveWireWord<2> {
+  typedef uint16_t type;
+  static constexpr uint16_t swap(uint16_t v) {
+    return __builtin_bswap16(v);
+  }
+};
+template <>
+struct MMWaveWireWord<4> {
+  typedef uint32_t type;
+  static constexpr uint32_t swap(uint32_t v) {
+    return __builtin_bswap32(v);
+  }
+};
+
+/**
+ * @brief Little-endian encoding of one scalar payload field.
+ */
+template <typename T>
+struct MMWaveWire {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "payload fields must be trivially copyable");
+
+  typedef MMWaveWireWord<sizeof(T)> Word;
+  typedef typename Word::type Raw;
+  static constexpr size_t kSize = sizeof(T);
+
+  static T decode(const uint8_t* src) {
+    Raw raw;
+    memcpy(&raw, src, sizeof(raw));
+    if constexpr (std::endian::native == std::endian::big)
+      raw = Word::swap(raw);
+    return std::bit_cast<T>(raw);
+  }
+
+  static void encode(T value, uint8_t* dst) {
+    Raw raw = std::bit_cast<Raw>(value);
+    if constexpr (std::endian::native == std::endian::big)
+      raw = Word::swap(raw);
+    memcpy(dst, &raw, sizeof(raw));
+  }
+};
+
+/**
+ * @brief Decoder of a whole payload into the struct T.
+ *
+ * Fields lists the wire type of every member of T in declaration order;
+ * offsets are computed at compile time and T is aggregate-initialised from
+ * the decoded values, so a report decodes in a handful of loads with no
+ * per-field bookkeeping at run time.
+ */
+template <typename T, typename... Fields>
+struct MMWavePayload {
+  typedef T Type;
+  static constexpr size_t kSize = (MMWaveWire<Fields>::kSize + ... + 0);
+  // Catches a field missing from the list: T would be partly left unset
+  static_assert(std::is_empty<T>::value || sizeof(T) == kSize,
+                "the fields do not cover T");
+
+  /**
+   * @retval false The payload is shorter than kSize, out is unchanged.
+   */
+  static bool decode(const uint8_t* src, size_t len, T& out) {
+    if (len < kSize)
+      return false;
+    out = decodeAt(src, std::index_sequence_for<Fields...>{});
+    return true;
+  }
+
+  /**
+   * @brief Decode from the receive ring, starting offset bytes into data.
+   *
+   * Contiguous payloads are decoded in place; the rare one wrapping around
+   * the end of the ring is first gathered into kSize bytes on the stack.
+   */
+  static bool decode(const MMWaveFrameView& data, T& out, size_t offset = 0) {
+    if (data.size() < offset + kSize)
+      return false;
+    if (offset + kSize <= data.firstLength()) {
+      out = decodeAt(data.first() + offset,
+                     std::index_sequence_for<Fields...>{});
+      return true;
+    }
+    uint8_t bytes[kSize ? kSize : 1];
+    data.copy(bytes, offset, kSize);
+    out = decodeAt(bytes, std::index_sequence_for<Fields...>{});
+    return true;
+  }
+
+  /**
+   * @brief Encode one value per field, used to build command payloads.
+   *
+   * @param dst At least kSize bytes.
+   * @return kSize.
+   */
+  static size_t encode(uint8_t* dst, Fields... values) {
+    encodeAt(dst, std::index_sequence_for<Fields...>{}, values...);
+    return kSize;
+  }
+
+  static constexpr size_t offset(size_t index) {
+    constexpr size_t sizes[] = {MMWaveWire<Fields>::kSize..., 0};
+    size_t pos               = 0;
+    for (size_t i = 0; i < index; i++)
+      pos += sizes[i];
+    return pos;
+  }
+
+ private:
+  template <size_t... I>
+  static T decodeAt(const uint8_t* src, std::index_sequence<I...>) {
+    (void)src;
+    return T{MMWaveWire<Fields>::decode(src + offset(I))...};
+  }
+
+  template <size_t... I>
+  static void encodeAt(uint8_t* dst, std::index_sequence<I...>,
+                       Fields... values) {
+    (void)dst;
+    (MMWaveWire<Fields>::encode(values, dst + offset(I)), ...);
+  }
+};
+
+typedef struct MMWaveEmpty {
+} MMWaveEmpty;
+
+// Frames without payload
+typedef MMWavePayload<MMWaveEmpty> MMWaveNoPayload;
+
+/**
+ * @brief Variable sized payload handed over undecoded.
+ *
+ * Used for reports such as point clouds whose handler decodes in place;
+ * only the minimum length is checked.
+ */
+template <size_t MinSize>
+struct MMWaveRawPayload {
+  typedef MMWaveFrameView Type;
+  static constexpr size_t kSize = MinSize;
+
+  static bool decode(const MMWaveFrameView& data, MMWaveFrameView& out) {
+    if (data.size() < kSize)
+      return false;
+    out = data;
+    return true;
+  }
+};
+
+#endif  // SEEEDMMWAVE_CODEC_H
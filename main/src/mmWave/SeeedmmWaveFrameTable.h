@@ -0,0 +1,54 @@
+/**
+ * @file SeeedmmWaveFrameTable.h
+ *
+ * @note Glue between the declarative frame tables of the devices and their
+ * handleType().
+ *
+ * Each device lists its frame types once, in an X-macro table giving the
+ * enum name, the type ID, the payload layout and the member receiving the
+ * decoded value (commands add the layout of their request). The table is
+ * expanded into the type enum, the request encoders and a switch in which
+ * every case calls mmwaveDecodeFrame() with a statically known layout and
+ * handler. A duplicated type ID fails to compile, the compiler lowers the
+ * switch to a jump table or a sorted compare tree, and each decoder and
+ * handler is inlined into its case.
+ */
+
+#ifndef SEEEDMMWAVE_FRAME_TABLE_H
+#define SEEEDMMWAVE_FRAME_TABLE_H
+
+#include <type_traits>
+
+#include "SeeedmmWaveCodec.h"
+
+/**
+ * @brief Check the size of a payload, decode it and hand it to a member.
+ *
+ * @tparam Handler The member receiving the value, taking a const reference
+ * to Payload::Type, or nullptr for frame types that are only sent.
+ * @retval false The payload is too short or the type is not handled.
+ */
+template <typename Device, typename Payload, auto Handler>
+inline bool mmwaveDecodeFrame(Device& device, const MMWaveFrameView& data) {
+  if constexpr (std::is_null_pointer<decltype(Handler)>::value) {
+    (void)device;
+    (void)data;
+    return false;
+  } else {
+    typename Payload::Type value;
+    if (!Payload::decode(data, value))
+      return false;
+    (device.*Handler)(value);
+    return true;
+  }
+}
+
+// Expands one table row into a case of the handleType() switch
+#define MMWAVE_DISPATCH_CASE(device, type, payload, handler)                   \
+  case type:                                                                   \
+    return mmwaveDecodeFrame<device, payload, handler>(*this, data);
+
+// Expands one table row into an enumerator
+#define MMWAVE_ENUM_VALUE(name, type) name = type,
+
+#endif  // SEEEDMMWAVE_FRAME_TABLE_H
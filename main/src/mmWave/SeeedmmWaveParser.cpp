@@ -0,0 +1,437 @@
+#include "SeeedmmWaveParser.h"
+
+#include <string.h>
+
+#define RX_RING_MASK (MMWAVE_RX_RING_SIZE - 1)
+
+static_assert(SeeedmmWaveParser::kMaxFrameLength <= FRAME_BUFFER_SIZE,
+              "FRAME_BUFFER_SIZE cannot hold the largest accepted frame");
+static_assert(FRAME_BUFFER_SIZE * 2 <= MMWAVE_RX_RING_SIZE,
+              "MMWAVE_RX_RING_SIZE is too small for FRAME_BUFFER_SIZE");
+static_assert(MMWAVE_RX_RING_SIZE - FRAME_BUFFER_SIZE <= UINT16_MAX,
+              "kMaxStreamPayload must fit the 16 bit length field");
+
+size_t MMWaveFrameView::copy(void* dst, size_t offset, size_t len) const {
+  uint8_t* out  = static_cast<uint8_t*>(dst);
+  size_t copied = 0;
+  if (offset < _first_len) {
+    size_t n = _first_len - offset;
+    if (n > len)
+      n = len;
+    memcpy(out, _first + offset, n);
+    copied = n;
+    offset = 0;
+  } else {
+    offset -= _first_len;
+  }
+  if (copied < len && offset < _second_len) {
+    size_t n = _second_len - offset;
+    if (n > len - copied)
+      n = len - copied;
+    memcpy(out + copied, _second + offset, n);
+    copied += n;
+  }
+  if (copied < len)
+    memset(out + copied, 0, len - copied);
+  return copied;
+}
+
+MMWaveFrameView MMWaveFrameView::subview(size_t offset, size_t len) const {
+  size_t total = size();
+  if (offset > total)
+    offset = total;
+  if (len > total - offset)
+    len = total - offset;
+  if (offset >= _first_len)
+    return MMWaveFrameView(_second + (offset - _first_len), len);
+  size_t run = _first_len - offset;
+  if (len <= run)
+    return MMWaveFrameView(_first + offset, len);
+  return MMWaveFrameView(_first + offset, run, _second, len - run);
+}
+
+MMWaveFrameView SeeedmmWaveParser::view(uint32_t pos, size_t len) const {
+  uint32_t idx = pos & RX_RING_MASK;
+  size_t run   = MMWAVE_RX_RING_SIZE - idx;
+  if (len <= run)
+    return MMWaveFrameView(&_ring[idx], len);
+  return MMWaveFrameView(&_ring[idx], run, &_ring[0], len - run);
+}
+
+/**
+ * @brief Ring position of the oldest byte that must not be overwritten.
+ */
+uint32_t SeeedmmWaveParser::oldest() const {
+  if (_count)
+    return _queue[_first].start;
+  // The bytes of a skipped frame are never looked at again
+  if (_state != State::Sof && _state != State::Skip)
+    return _frame_start;
+  return _scan;
+}
+
+uint8_t* SeeedmmWaveParser::writeBuffer(size_t& len) {
+  // Make room by dropping the oldest frames. A pinned front frame holds the
+  // oldest bytes itself: it is never evicted, and evicting the frames behind
+  // it would free nothing
+  while (_head - oldest() == MMWAVE_RX_RING_SIZE && _count && !_pinned) {
+    evict();
+  }
+  // A long frame behind a pinned one can still fill the ring, give it up
+  if (_head - oldest() == MMWAVE_RX_RING_SIZE && _state != State::Sof &&
+      _state != State::Skip) {
+    if (_state != State::Header) {
+      stats((_header[5] << 8) | _header[6]).dropped++;
+      _stats.overflowed++;
+    }
+    _state = State::Sof;
+  }
+  uint32_t idx = _head & RX_RING_MASK;
+  size_t free  = MMWAVE_RX_RING_SIZE - (_head - oldest());
+  size_t run   = MMWAVE_RX_RING_SIZE - idx;
+  len          = free < run ? free : run;
+  return &_ring[idx];
+}
+
+void SeeedmmWaveParser::recordInterval(MMWaveTypeStats& stats,
+                                       int64_t timestamp_us) {
+  if (stats.last_us) {
+    int64_t delta = timestamp_us - stats.last_us;
+    uint32_t interval =
+        delta < 0 ? 0 : (delta > UINT32_MAX ? UINT32_MAX : uint32_t(delta));
+    if (stats.intervals == 0 || interval < stats.interval_min_us)
+      stats.interval_min_us = interval;
+    if (interval > stats.interval_max_us)
+      stats.interval_max_us = interval;
+    stats.interval_sum_us += interval;
+    stats.interval_sq_sum_us += uint64_t(interval) * interval;
+    stats.intervals++;
+  }
+  stats.last_us = timestamp_us;
+}
+
+void SeeedmmWaveParser::recordId(uint16_t id) {
+  if (_id_filter && _id_filter(id, _id_filter_ctx))
+    return;
+  if (_id_valid && id != uint16_t(_last_id + 1)) {
+    _stats.id_gaps++;
+    uint16_t step = id - _last_id - 1;
+    // A step back or a huge jump is a restart rather than lost frames
+    if (step < 0x8000)
+      _stats.ids_missed += step;
+  }
+  _last_id  = id;
+  _id_valid = true;
+}
+
+void SeeedmmWaveParser::push(const MMWaveFrame& frame) {
+  recordInterval(stats(frame.type), frame.timestamp_us);
+  const MMWaveQueueRule& rule = queueRule(frame.type);
+  if (rule.policy == MMWaveQueuePolicy::LatestOnly) {
+    // At most one frame of the type is queued, unless it is being handled
+    for (size_t i = _count; i-- > (_pinned ? 1u : 0u);) {
+      if (at(i).type == frame.type) {
+        stats(frame.type).coalesced++;
+        erase(i);
+        break;
+      }
+    }
+  }
+  if (_count == MMWaveMaxQueueSize && !makeRoom(rule)) {
+    stats(frame.type).dropped++;
+    _stats.overflowed++;
+    return;
+  }
+  at(_count) = frame;
+  _count++;
+  _stats.frames++;
+  if (frame.truncated)
+    stats(frame.type).truncated++;
+  else
+    stats(frame.type).accepted++;
+}
+
+/**
+ * @brief Evict a frame from the full queue for a new frame following rule.
+ *
+ * The victim is the oldest frame of the lowest priority, never the pinned
+ * one, and never of a higher priority than the new frame.
+ *
+ * @retval false The new frame must be dropped instead.
+ */
+bool SeeedmmWaveParser::makeRoom(const MMWaveQueueRule& rule) {
+  if (rule.policy == MMWaveQueuePolicy::DropWhenFull)
+    return false;
+  size_t victim  = _count;
+  uint8_t lowest = 0;
+  for (size_t i = _pinned ? 1 : 0; i < _count; i++) {
+    uint8_t priority = queueRule(at(i).type).priority;
+    if (victim == _count || priority < lowest) {
+      victim = i;
+      lowest = priority;
+      if (lowest == 0)
+        break;  // Nothing can be lower
+    }
+  }
+  if (victim == _count || lowest > rule.priority)
+    return false;
+  stats(at(victim).type).dropped++;
+  _stats.evicted++;
+  erase(victim);
+  return true;
+}
+
+/**
+ * @brief Remove a queued frame. Its ring bytes are reclaimed once every
+ * frame queued before it is gone.
+ */
+void SeeedmmWaveParser::erase(size_t index) {
+  if (index == 0) {
+    _first = (_first + 1) % MMWaveMaxQueueSize;
+  } else {
+    for (size_t i = index; i + 1 < _count; i++) {
+      at(i) = at(i + 1);
+    }
+  }
+  _count--;
+}
+
+void SeeedmmWaveParser::evict() {
+  stats(_queue[_first].type).dropped++;
+  _stats.evicted++;
+  pop();
+}
+
+MMWaveTypeStats& SeeedmmWaveParser::stats(uint16_t type) {
+  if (_type_stats_last < _type_stats_count &&
+      _type_stats[_type_stats_last].type == type)
+    return _type_stats[_type_stats_last];
+  for (size_t i = 0; i < _type_stats_count; i++) {
+    if (_type_stats[i].type == type) {
+      _type_stats_last = i;
+      return _type_stats[i];
+    }
+  }
+  // The last entry is kept for every type seen once the table is full
+  size_t i = _type_stats_count;
+  if (i >= MMWAVE_TYPE_STATS_SIZE - 1) {
+    i    = MMWAVE_TYPE_STATS_SIZE - 1;
+    type = 0xFFFF;
+  }
+  if (i == _type_stats_count) {
+    _type_stats[i]      = MMWaveTypeStats();
+    _type_stats[i].type = type;
+    _type_stats_count++;
+  }
+  _type_stats_last = i;
+  return _type_stats[i];
+}
+
+bool SeeedmmWaveParser::setAcceptedTypes(const uint16_t* types,
+                                         size_t count) {
+  if (count > MMWAVE_ACCEPT_TYPES_SIZE)
+    return false;
+  for (size_t i = 0; i < count; i++) {
+    _accept[i] = types[i];
+  }
+  _accept_count = count;
+  return true;
+}
+
+bool SeeedmmWaveParser::setQueueRule(uint16_t type, MMWaveQueuePolicy policy,
+                                     uint8_t priority) {
+  size_t i = 0;
+  while (i < _rule_count && _rules[i].type != type) {
+    i++;
+  }
+  if (i == MMWAVE_QUEUE_RULES_SIZE)
+    return false;
+  _rules[i] = {type, policy, priority};
+  if (i == _rule_count)
+    _rule_count++;
+  return true;
+}
+
+const MMWaveQueueRule& SeeedmmWaveParser::queueRule(uint16_t type) const {
+  static const MMWaveQueueRule kDefault = {0xFFFF, MMWaveQueuePolicy::KeepAll,
+                                           0};
+  for (size_t i = 0; i < _rule_count; i++) {
+    if (_rules[i].type == type)
+      return _rules[i];
+  }
+  return kDefault;
+}
+
+void SeeedmmWaveParser::resetTypeStats() {
+  _type_stats_count = 0;
+  _type_stats_last  = 0;
+}
+
+void SeeedmmWaveParser::pop() {
+  if (_count == 0)
+    return;
+  _first = (_first + 1) % MMWaveMaxQueueSize;
+  _count--;
+  _pinned = false;
+}
+
+/**
+ * @brief Give up the current candidate frame and look for the next SOF.
+ *
+ * A 0x01 byte inside a payload or a corrupted header makes a false start.
+ * The bytes following the rejected SOF are still in the ring, so scanning
+ * resumes right after it instead of discarding what was consumed; a real
+ * frame hidden behind the false start is then found without waiting for
+ * more input.
+ */
+void SeeedmmWaveParser::resync() {
+  _scan  = _frame_start + 1;
+  _state = State::Sof;
+}
+
+void SeeedmmWaveParser::reset() {
+  _head      = 0;
+  _scan      = 0;
+  _chunk_end = 0;
+  _state     = State::Sof;
+  _pos       = 0;
+  _first     = 0;
+  _count     = 0;
+  _pinned    = false;
+}
+
+/**
+ * @brief Consume buffered bytes until a complete frame is queued.
+ *
+ * Each iteration works on the longest contiguous run of the ring so that the
+ * SOF search and the payload checksum are tight loops. The header checksum
+ * is accumulated while the header is read and checked once its last byte
+ * arrives; the data checksum is folded over the payload in place. Frames
+ * failing either checksum are dropped here and never reach the queue, and
+ * the search for the next SOF restarts right after the rejected one over
+ * the bytes already in the ring. Frames whose type is not accepted are
+ * skipped as soon as their header is verified.
+ */
+bool SeeedmmWaveParser::next() {
+  while (_scan != _head) {
+    uint32_t idx       = _scan & RX_RING_MASK;
+    size_t avail       = _head - _scan;
+    size_t run         = MMWAVE_RX_RING_SIZE - idx;
+    const uint8_t* src = &_ring[idx];
+    if (run > avail)
+      run = avail;
+
+    switch (_state) {
+      case State::Sof: {
+        const uint8_t* sof =
+            static_cast<const uint8_t*>(memchr(src, SOF_BYTE, run));
+        if (sof == nullptr) {
+          _scan += run;
+          break;
+        }
+        _frame_start = _scan + (sof - src);
+        _scan        = _frame_start + 1;
+        _header[0]   = SOF_BYTE;
+        _pos         = SIZE_SOF;
+        _head_cksum  = SOF_BYTE;
+        _state       = State::Header;
+        // The chunk's last byte arrived at _chunk_time_us, the SOF one byte
+        // time earlier for every byte received after it
+        _frame_time_us =
+            _chunk_time_us -
+            int64_t(_chunk_end - 1 - _frame_start) * _byte_ns / 1000;
+        break;
+      }
+      case State::Header: {
+        size_t n = SIZE_FRAME_HEADER - _pos;
+        if (n > run)
+          n = run;
+        for (size_t i = 0; i < n; i++) {
+          uint8_t byte = src[i];
+          if (_pos < SIZE_FRAME_HEADER - SIZE_HEAD_CKSUM)
+            _head_cksum ^= byte;
+          _header[_pos++] = byte;
+        }
+        _scan += n;
+        if (_pos < SIZE_FRAME_HEADER)
+          break;
+
+        _data_len = (_header[3] << 8) | _header[4];
+        if (static_cast<uint8_t>(~_head_cksum) != _header[7]) {
+          _stats.header_errors++;
+          resync();
+          break;
+        }
+        uint16_t type = (_header[5] << 8) | _header[6];
+        // No real frame is this long, skipped or not: a header checksum
+        // matching by chance, hunt for the next SOF rather than trust it
+        if (_data_len > kMaxStreamPayload) {
+          stats(type).dropped++;
+          _stats.oversize++;
+          resync();
+          break;
+        }
+        if (!accepts(type)) {
+          // Nothing is kept, the payload is stepped over unchecked
+          stats(type).skipped++;
+          _pos   = 0;
+          _state = State::Skip;
+          break;
+        }
+        _pos        = 0;
+        _data_cksum = 0;
+        _state      = _data_len ? State::Payload : State::DataChecksum;
+        break;
+      }
+      case State::Payload: {
+        size_t n = _data_len - _pos;
+        if (n > run)
+          n = run;
+        uint8_t cksum = _data_cksum;
+        for (size_t i = 0; i < n; i++) {
+          cksum ^= src[i];
+        }
+        _data_cksum = cksum;
+        _pos += n;
+        _scan += n;
+        if (_pos == _data_len)
+          _state = State::DataChecksum;
+        break;
+      }
+      case State::DataChecksum: {
+        uint8_t byte = *src;
+        if (static_cast<uint8_t>(~_data_cksum) != byte) {
+          _stats.data_errors++;
+          resync();
+          break;
+        }
+        _scan++;
+        _state = State::Sof;
+
+        MMWaveFrame frame;
+        frame.start        = _frame_start;
+        frame.timestamp_us = _frame_time_us;
+        frame.id           = (_header[1] << 8) | _header[2];
+        frame.type         = (_header[5] << 8) | _header[6];
+        frame.truncated    = _data_len > kMaxPayload;
+        frame.data_len     = frame.truncated ? kMaxPayload : _data_len;
+        recordId(frame.id);
+        push(frame);
+        return true;
+      }
+      case State::Skip: {
+        size_t n = _data_len + SIZE_DATA_CKSUM - _pos;
+        if (n > run)
+          n = run;
+        _pos += n;
+        _scan += n;
+        if (_pos == size_t(_data_len + SIZE_DATA_CKSUM)) {
+          recordId((_header[1] << 8) | _header[2]);
+          _state = State::Sof;
+        }
+        break;
+      }
+    }
+  }
+  return false;
+}
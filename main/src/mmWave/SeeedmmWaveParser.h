@@ -0,0 +1,422 @@
+/**
+ * @file SeeedmmWaveParser.h
+ *
+ * @note Streaming frame parser for the Seeed mmWave UART protocol.
+ *
+ * Bytes are bulk-read from the UART into a ring buffer and consumed by a
+ * small state machine that folds the header and data checksums in while the
+ * bytes go by, so every received byte is touched exactly once. Complete
+ * frames are not copied out of the ring: the frame queue only records where
+ * each frame starts, and consumers read the payload through a
+ * MMWaveFrameView pointing into the ring.
+ */
+
+#ifndef SEEEDMMWAVE_PARSER_H
+#define SEEEDMMWAVE_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_BUFFER_SIZE 512
+#define SOF_BYTE          0x01
+
+// Frame structure sizes
+#define SIZE_SOF        1
+#define SIZE_ID         2
+#define SIZE_LEN        2
+#define SIZE_TYPE       2
+#define SIZE_HEAD_CKSUM 1
+#define SIZE_FRAME_HEADER                                                      \
+  (SIZE_SOF + SIZE_ID + SIZE_LEN + SIZE_TYPE + SIZE_HEAD_CKSUM)
+#define SIZE_DATA_CKSUM 1
+
+#ifndef MMWaveMaxQueueSize
+#  define MMWaveMaxQueueSize 120
+#endif
+
+// Holds the bytes of every queued frame plus the one being received
+#ifndef MMWAVE_RX_RING_SIZE
+#  define MMWAVE_RX_RING_SIZE 4096
+#endif
+
+static_assert((MMWAVE_RX_RING_SIZE & (MMWAVE_RX_RING_SIZE - 1)) == 0,
+              "MMWAVE_RX_RING_SIZE must be a power of two");
+
+// Payloads up to this size are queued whole, longer ones (multi-target point
+// clouds) are queued with the payload truncated to it
+#ifndef MMWAVE_MAX_PAYLOAD
+#  define MMWAVE_MAX_PAYLOAD                                                   \
+    (FRAME_BUFFER_SIZE - SIZE_FRAME_HEADER - SIZE_DATA_CKSUM)
+#endif
+
+// Number of distinct frame types counted separately in MMWaveTypeStats
+#ifndef MMWAVE_TYPE_STATS_SIZE
+#  define MMWAVE_TYPE_STATS_SIZE 16
+#endif
+
+// Frame types that can be listed in the accept mask
+#ifndef MMWAVE_ACCEPT_TYPES_SIZE
+#  define MMWAVE_ACCEPT_TYPES_SIZE 8
+#endif
+
+// Frame types that can be given their own queue policy
+#ifndef MMWAVE_QUEUE_RULES_SIZE
+#  define MMWAVE_QUEUE_RULES_SIZE 8
+#endif
+
+/**
+ * @brief Read-only view of bytes held in the receive ring.
+ *
+ * A frame that wraps around the end of the ring is seen as two runs; most
+ * frames are contiguous and only use the first one.
+ */
+class MMWaveFrameView {
+ public:
+  MMWaveFrameView() {}
+  MMWaveFrameView(const uint8_t* data, size_t len)
+      : _first(data), _first_len(len) {}
+  MMWaveFrameView(const uint8_t* first, size_t first_len,
+                  const uint8_t* second, size_t second_len)
+      : _first(first),
+        _second(second),
+        _first_len(first_len),
+        _second_len(second_len) {}
+
+  size_t size() const {
+    return _first_len + _second_len;
+  }
+  bool contiguous() const {
+    return _second_len == 0;
+  }
+  const uint8_t* first() const {
+    return _first;
+  }
+  size_t firstLength() const {
+    return _first_len;
+  }
+  const uint8_t* second() const {
+    return _second;
+  }
+  size_t secondLength() const {
+    return _second_len;
+  }
+  uint8_t operator[](size_t i) const {
+    return i < _first_len ? _first[i] : _second[i - _first_len];
+  }
+
+  /**
+   * @brief Copy bytes out of the view, across the wrap if needed.
+   *
+   * @return The number of bytes copied, less than len when the view ends
+   * first. The remainder of dst is zero-filled.
+   */
+  size_t copy(void* dst, size_t offset, size_t len) const;
+  MMWaveFrameView subview(size_t offset, size_t len) const;
+
+ private:
+  const uint8_t* _first  = nullptr;
+  const uint8_t* _second = nullptr;
+  size_t _first_len      = 0;
+  size_t _second_len     = 0;
+};
+
+/**
+ * @brief A queued frame whose checksums have been verified.
+ *
+ * data_len is the length of the payload handed to the handler, already
+ * clipped to MMWAVE_MAX_PAYLOAD for truncated frames.
+ */
+typedef struct MMWaveFrame {
+  uint32_t start;        // ring position of the SOF byte
+  int64_t timestamp_us;  // esp_timer time the SOF byte was received
+  uint16_t id;
+  uint16_t type;
+  uint16_t data_len;
+  bool truncated;
+} MMWaveFrame;
+
+/**
+ * @brief How the frames of a type are queued.
+ */
+enum class MMWaveQueuePolicy : uint8_t {
+  KeepAll,       // every frame is queued, the default
+  LatestOnly,    // a new frame replaces the one of the type still queued
+  DropWhenFull,  // never evicts another frame, dropped when the queue is full
+};
+
+/**
+ * @brief Queue policy of one frame type.
+ *
+ * When the queue is full, the oldest frame of the lowest priority is evicted
+ * to make room, unless the new frame has a lower priority still, in which
+ * case the new frame is dropped. Types without a rule are KeepAll with
+ * priority 0.
+ */
+typedef struct MMWaveQueueRule {
+  uint16_t type;
+  MMWaveQueuePolicy policy;
+  uint8_t priority;  // higher is evicted last
+} MMWaveQueueRule;
+
+/**
+ * @brief Reception counters of one frame type.
+ *
+ * The interval fields describe the time between consecutive valid frames of
+ * the type: the mean is interval_sum_us / intervals, the jitter its standard
+ * deviation, derived from interval_sq_sum_us.
+ */
+typedef struct MMWaveTypeStats {
+  uint16_t type;
+  uint32_t accepted;   // queued with the whole payload
+  uint32_t truncated;  // queued with the payload cut to MMWAVE_MAX_PAYLOAD
+  uint32_t dropped;    // too large to buffer, or evicted from a full queue
+  uint32_t skipped;    // not in the accept mask, never buffered
+  uint32_t coalesced;  // replaced in the queue by a newer frame (LatestOnly)
+
+  int64_t last_us;  // timestamp of the latest valid frame
+  uint32_t intervals;
+  uint32_t interval_min_us;
+  uint32_t interval_max_us;
+  uint64_t interval_sum_us;
+  uint64_t interval_sq_sum_us;
+} MMWaveTypeStats;
+
+/**
+ * @brief Stream level counters of the parser, covering every frame type.
+ *
+ * A header error is a candidate SOF whose header checksum did not match;
+ * after a corrupted frame the search for the next SOF goes over its payload,
+ * so one lost frame may count several. evicted counts queued frames given
+ * up for newer ones, overflowed new frames dropped for lack of room in the
+ * queue or the ring. The frame ID is expected to advance by one per frame
+ * received whole, queued or skipped: every other step counts as an ID gap,
+ * and the IDs jumped over on a forward step as missed. IDs picked out by the
+ * filter given to setIdFilter(), such as those of command responses, are
+ * outside the sequence and not counted.
+ */
+typedef struct MMWaveParserStats {
+  uint64_t bytes;   // committed to the ring
+  uint32_t frames;  // queued, whole or truncated
+  uint32_t header_errors;
+  uint32_t data_errors;
+  uint32_t oversize;  // longer than kMaxStreamPayload, dropped
+  uint32_t evicted;
+  uint32_t overflowed;
+  uint32_t id_gaps;
+  uint32_t ids_missed;
+} MMWaveParserStats;
+
+class SeeedmmWaveParser {
+ public:
+  static constexpr uint16_t kMaxPayload = MMWAVE_MAX_PAYLOAD;
+  static constexpr size_t kMaxFrameLength =
+      SIZE_FRAME_HEADER + kMaxPayload + SIZE_DATA_CKSUM;
+  // Longest payload that can still stream through the ring to have its
+  // checksum verified; anything longer is dropped as soon as the header is in
+  static constexpr uint16_t kMaxStreamPayload =
+      MMWAVE_RX_RING_SIZE - FRAME_BUFFER_SIZE - SIZE_FRAME_HEADER -
+      SIZE_DATA_CKSUM;
+
+  SeeedmmWaveParser() {}
+
+  /**
+   * @brief Contiguous free space at the write end of the ring.
+   *
+   * When the ring is full the oldest queued frames are evicted to make room.
+   * While front() pins a frame nothing is evicted: once the ring is full up
+   * to the pinned frame, the frame being received is given up and len is 0
+   * until pop().
+   *
+   * @param len Set to the number of bytes that may be written at the
+   * returned pointer. Call commit() once they are filled.
+   */
+  uint8_t* writeBuffer(size_t& len);
+
+  /**
+   * @brief Append the bytes filled in at writeBuffer().
+   *
+   * @param time_us The time the last of these bytes was received. Frames
+   * starting in them are timestamped by going back one byte time per byte
+   * between their SOF and the end of the chunk.
+   */
+  void commit(size_t len, int64_t time_us = 0) {
+    _head += len;
+    _stats.bytes += len;
+    _chunk_end     = _head;
+    _chunk_time_us = time_us;
+  }
+
+  /**
+   * @brief Time one byte takes on the wire, used to back-date the SOF.
+   *
+   * 0, the default, leaves frames stamped with the time their chunk came in.
+   */
+  void setByteTime(uint32_t byte_ns) {
+    _byte_ns = byte_ns;
+  }
+
+  /**
+   * @brief Restrict the frames queued to a set of types.
+   *
+   * The type is checked as soon as the header checksum matches. Frames of
+   * other types are skipped over in the ring: their payload is neither
+   * checksummed nor queued, and their bytes are free for reuse at once.
+   * A length over kMaxStreamPayload is dropped as oversize whatever the type.
+   *
+   * @param types The accepted types, count 0 to accept every type.
+   * @retval false More than MMWAVE_ACCEPT_TYPES_SIZE types, the mask is
+   * unchanged.
+   */
+  bool setAcceptedTypes(const uint16_t* types, size_t count);
+
+  /**
+   * @brief Set the queue policy and eviction priority of a frame type.
+   *
+   * @retval false The rule table is full.
+   */
+  bool setQueueRule(uint16_t type, MMWaveQueuePolicy policy,
+                    uint8_t priority);
+  const MMWaveQueueRule& queueRule(uint16_t type) const;
+  bool accepts(uint16_t type) const {
+    if (_accept_count == 0)
+      return true;
+    for (size_t i = 0; i < _accept_count; i++) {
+      if (_accept[i] == type)
+        return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Leave frames out of the ID sequence behind id_gaps.
+   *
+   * @param filter Called with the ID of every frame received whole, returns
+   * true for an ID that is not the sensor's own, e.g. a command response
+   * echoing the request's ID. nullptr counts every frame.
+   */
+  typedef bool (*IdFilter)(uint16_t id, void* ctx);
+  void setIdFilter(IdFilter filter, void* ctx) {
+    _id_filter     = filter;
+    _id_filter_ctx = ctx;
+  }
+
+  /**
+   * @brief Advance the state machine over the buffered bytes.
+   *
+   * @retval true A frame with valid header and data checksums was queued.
+   * @retval false Every buffered byte has been consumed.
+   */
+  bool next();
+
+  bool empty() const {
+    return _count == 0;
+  }
+  size_t size() const {
+    return _count;
+  }
+
+  /**
+   * @brief The oldest queued frame.
+   *
+   * The frame is pinned: its bytes stay valid and are not evicted until
+   * pop() releases it.
+   */
+  const MMWaveFrame& front() {
+    _pinned = true;
+    return _queue[_first];
+  }
+  void pop();
+
+  MMWaveFrameView payload(const MMWaveFrame& frame) const {
+    return view(frame.start + SIZE_FRAME_HEADER, frame.data_len);
+  }
+  MMWaveFrameView bytes(const MMWaveFrame& frame) const {
+    return view(frame.start,
+                SIZE_FRAME_HEADER + frame.data_len + SIZE_DATA_CKSUM);
+  }
+
+  /**
+   * @brief Per frame type reception counters, in order of first appearance.
+   *
+   * Types seen after the table is full are accounted under type 0xFFFF in
+   * the last entry.
+   */
+  const MMWaveTypeStats* typeStats(size_t& count) const {
+    count = _type_stats_count;
+    return _type_stats;
+  }
+  void resetTypeStats();
+
+  const MMWaveParserStats& parserStats() const {
+    return _stats;
+  }
+  void resetParserStats() {
+    _stats    = MMWaveParserStats();
+    _id_valid = false;
+  }
+
+  void reset();
+
+ private:
+  enum class State : uint8_t {
+    Sof,
+    Header,
+    Payload,
+    DataChecksum,
+    Skip,  // payload and checksum of a frame not in the accept mask
+  };
+
+  MMWaveFrameView view(uint32_t pos, size_t len) const;
+  uint32_t oldest() const;
+  MMWaveFrame& at(size_t index) {
+    return _queue[(_first + index) % MMWaveMaxQueueSize];
+  }
+  void push(const MMWaveFrame& frame);
+  bool makeRoom(const MMWaveQueueRule& rule);
+  void erase(size_t index);
+  void evict();
+  void resync();
+  MMWaveTypeStats& stats(uint16_t type);
+  void recordInterval(MMWaveTypeStats& stats, int64_t timestamp_us);
+  void recordId(uint16_t id);
+
+  uint8_t _ring[MMWAVE_RX_RING_SIZE];
+  uint32_t _head = 0;  // free running write position
+  uint32_t _scan = 0;  // free running parse position
+
+  uint32_t _chunk_end    = 0;  // _head when _chunk_time_us was taken
+  int64_t _chunk_time_us = 0;
+  uint32_t _byte_ns      = 0;
+
+  State _state          = State::Sof;
+  uint32_t _frame_start = 0;
+  int64_t _frame_time_us = 0;
+  uint8_t _header[SIZE_FRAME_HEADER];
+  size_t _pos         = 0;
+  uint16_t _data_len  = 0;
+  uint8_t _head_cksum = 0;
+  uint8_t _data_cksum = 0;
+
+  MMWaveFrame _queue[MMWaveMaxQueueSize];
+  size_t _first = 0;
+  size_t _count = 0;
+  bool _pinned  = false;
+
+  uint16_t _accept[MMWAVE_ACCEPT_TYPES_SIZE];
+  size_t _accept_count = 0;
+
+  MMWaveQueueRule _rules[MMWAVE_QUEUE_RULES_SIZE];
+  size_t _rule_count = 0;
+
+  MMWaveTypeStats _type_stats[MMWAVE_TYPE_STATS_SIZE];
+  size_t _type_stats_count = 0;
+  size_t _type_stats_last  = 0;
+
+  MMWaveParserStats _stats = {};
+  uint16_t _last_id        = 0;
+  bool _id_valid           = false;
+  IdFilter _id_filter      = nullptr;
+  void* _id_filter_ctx     = nullptr;
+};
+
+#endif  // SEEEDMMWAVE_PARSER_H
@@ -0,0 +1,80 @@
+/**
+ * @file SeeedmmWaveSeqLock.h
+ *
+ * @note Sequence lock publishing a small value to any number of readers.
+ *
+ * One writer updates the value; readers copy it without any lock and retry
+ * when the copy overlapped an update, recognised by the sequence number
+ * being odd or having changed. Readers never delay the writer or each
+ * other. The value is stored as relaxed atomic words so that the racing
+ * copies are well defined.
+ */
+
+#ifndef SEEEDMMWAVE_SEQLOCK_H
+#define SEEEDMMWAVE_SEQLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <type_traits>
+
+template <typename T>
+class SeeedmmWaveSeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "T must be trivially copyable");
+
+ public:
+  SeeedmmWaveSeqLock() {}
+
+  /**
+   * @brief Writer side: publish a new value. There must be a single writer.
+   */
+  void write(const T& value) {
+    uint32_t words[kWords] = {};
+    memcpy(words, &value, sizeof(T));
+
+    uint32_t seq = _seq.load(std::memory_order_relaxed);
+    _seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; i++) {
+      _words[i].store(words[i], std::memory_order_relaxed);
+    }
+    _seq.store(seq + 2, std::memory_order_release);
+  }
+
+  /**
+   * @brief Reader side: copy the latest value.
+   *
+   * @retval false The copy raced with an update, out is unchanged; try
+   * again.
+   */
+  bool tryRead(T& out) const {
+    uint32_t seq = _seq.load(std::memory_order_acquire);
+    if (seq & 1)
+      return false;
+    uint32_t words[kWords];
+    for (size_t i = 0; i < kWords; i++) {
+      words[i] = _words[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (_seq.load(std::memory_order_relaxed) != seq)
+      return false;
+    memcpy(&out, words, sizeof(T));
+    return true;
+  }
+
+  // Advances by two for every write()
+  uint32_t sequence() const {
+    return _seq.load(std::memory_order_acquire);
+  }
+
+ private:
+  static constexpr size_t kWords = (sizeof(T) + 3) / 4;
+
+  std::atomic<uint32_t> _words[kWords] = {};
+  std::atomic<uint32_t> _seq{0};
+};
+
+#endif  // SEEEDMMWAVE_SEQLOCK_H
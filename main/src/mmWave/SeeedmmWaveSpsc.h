@@ -0,0 +1,120 @@
+/**
+ * @file SeeedmmWaveSpsc.h
+ *
+ * @note Lock-free single-producer/single-consumer ring.
+ *
+ * One task pushes and one task pops; the two only synchronise through the
+ * acquire/release ordering of the head and tail indices, so neither side
+ * ever blocks the other.
+ */
+
+#ifndef SEEEDMMWAVE_SPSC_H
+#define SEEEDMMWAVE_SPSC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <span>
+
+template <typename T, size_t N>
+class SeeedmmWaveSpscRing {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of two");
+
+ public:
+  SeeedmmWaveSpscRing() {}
+
+  static constexpr size_t capacity() {
+    return N;
+  }
+
+  /**
+   * @brief Producer side: append an item.
+   *
+   * @retval false The ring is full, the item is dropped and counted.
+   */
+  bool push(const T& item) {
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    uint32_t tail = _tail.load(std::memory_order_acquire);
+    if (head - tail == N) {
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    _items[head & (N - 1)] = item;
+    _head.store(head + 1, std::memory_order_release);
+
+    uint32_t used = head + 1 - tail;
+    if (used > _high_water.load(std::memory_order_relaxed))
+      _high_water.store(used, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * @brief Consumer side: take the oldest item.
+   *
+   * @retval false The ring is empty.
+   */
+  bool pop(T& item) {
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    uint32_t head = _head.load(std::memory_order_acquire);
+    if (head == tail)
+      return false;
+    item = _items[tail & (N - 1)];
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Consumer side: take as many of the oldest items as fit in out.
+   *
+   * Items are copied in at most two contiguous blocks, the second one when
+   * the stored items wrap around the end of the ring.
+   *
+   * @return The number of items copied to the front of out.
+   */
+  size_t drain(std::span<T> out) {
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    uint32_t head = _head.load(std::memory_order_acquire);
+    size_t n      = head - tail;
+    if (n > out.size())
+      n = out.size();
+    size_t idx = tail & (N - 1);
+    size_t run = N - idx;
+    if (run > n)
+      run = n;
+    std::copy_n(&_items[idx], run, out.data());
+    std::copy_n(&_items[0], n - run, out.data() + run);
+    _tail.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  size_t size() const {
+    return _head.load(std::memory_order_acquire) -
+           _tail.load(std::memory_order_acquire);
+  }
+  bool empty() const {
+    return size() == 0;
+  }
+
+  // Highest occupancy observed by the producer
+  size_t highWater() const {
+    return _high_water.load(std::memory_order_relaxed);
+  }
+  uint32_t dropped() const {
+    return _dropped.load(std::memory_order_relaxed);
+  }
+  void resetStats() {
+    _high_water.store(0, std::memory_order_relaxed);
+    _dropped.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  T _items[N];
+  std::atomic<uint32_t> _head{0};
+  std::atomic<uint32_t> _tail{0};
+  std::atomic<uint32_t> _high_water{0};
+  std::atomic<uint32_t> _dropped{0};
+};
+
+#endif  // SEEEDMMWAVE_SPSC_H
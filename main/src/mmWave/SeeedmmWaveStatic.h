@@ -0,0 +1,43 @@
+/**
+ * @file SeeedmmWaveStatic.h
+ *
+ * @note Statically dispatched front end for a mmWave device.
+ *
+ * SeeedmmWave hands every frame to the virtual handleType(), an indirect
+ * call the compiler can neither inline nor specialise. SeeedmmWaveT<Device>
+ * is the same sensor object with its frame loop instantiated for Device:
+ * each frame goes straight to Device::handleType(), whose generated switch
+ * and payload decoders are then compiled into the loop. Only the call of
+ * the loop itself, once per batch of frames, remains virtual, so the
+ * virtual interface keeps working unchanged and both can be mixed.
+ *
+ *   SeeedmmWaveT<SEEED_MR60BHA2> mmWave;  // instead of SEEED_MR60BHA2
+ */
+
+#ifndef SEEEDMMWAVE_STATIC_H
+#define SEEEDMMWAVE_STATIC_H
+
+#include <type_traits>
+
+#include "SeeedmmWave.h"
+
+template <typename Device>
+class SeeedmmWaveT final : public Device {
+  static_assert(std::is_base_of<SeeedmmWave, Device>::value,
+                "Device must be a SeeedmmWave sensor");
+
+ public:
+  using Device::Device;
+
+  bool processQueuedFrames(uint16_t data_type = 0xFFFF,
+                           uint32_t timeout   = 1000) override {
+    return this->processFramesWith(
+        data_type, timeout,
+        [this](uint16_t type, const MMWaveFrameView& data) {
+          // Qualified: a direct call, not through the vtable
+          return this->Device::handleType(type, data);
+        });
+  }
+};
+
+#endif  // SEEEDMMWAVE_STATIC_H
@@ -0,0 +1,204 @@
+/**
+ * @file SeeedmmWaveTransport.h
+ *
+ * @note Byte stream between SeeedmmWave and the sensor.
+ *
+ * SeeedmmWave only needs a few byte-level operations from the link to the
+ * radar; this interface is that set. On the ESP32 it is implemented over
+ * HardwareSerial by SeeedmmWaveSerialTransport, which begin(HardwareSerial*)
+ * sets up internally. Other implementations, such as the replay transport
+ * of the host build, feed the unchanged parser and handleType() logic from
+ * recorded captures.
+ */
+
+#ifndef SEEEDMMWAVE_TRANSPORT_H
+#define SEEEDMMWAVE_TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_timer.h"
+
+class SeeedmmWaveTransport {
+ public:
+  virtual ~SeeedmmWaveTransport() {}
+
+  virtual void begin(uint32_t baud) {
+    (void)baud;
+  }
+  virtual void end() {}
+
+  // Bytes that read() returns without waiting
+  virtual size_t available() = 0;
+  virtual size_t read(uint8_t* data, size_t len) = 0;
+
+  /**
+   * @brief esp_timer time, in microseconds, at which the last byte returned
+   * by read() was received.
+   *
+   * The default is the current time, only right when the bytes are read as
+   * soon as they arrive. SeeedmmWaveSerialTransport returns the time of the
+   * UART receive event that delivered them; a replay returns the time
+   * recorded in the capture so that frame timestamps and intervals are
+   * those of the original session, whatever the replay speed.
+   */
+  virtual int64_t receiveTime() {
+    return esp_timer_get_time();
+  }
+
+  // Bytes write() accepts without blocking
+  virtual size_t availableForWrite() = 0;
+  virtual size_t write(const uint8_t* data, size_t len) = 0;
+
+  /**
+   * @brief Have callback(ctx) called whenever bytes arrive.
+   *
+   * Used by FetchMode::EventDriven; callback nullptr detaches it. The
+   * callback may run in any task and only signals a semaphore.
+   *
+   * @retval false The transport cannot signal arrivals.
+   */
+  virtual bool onReceive(void (*callback)(void* ctx), void* ctx) {
+    (void)callback;
+    (void)ctx;
+    return false;
+  }
+};
+
+#ifndef MMWAVE_HOST
+#  include <HardwareSerial.h>
+
+#  include <atomic>
+
+#  include "freertos/FreeRTOS.h"
+
+// UART receive events remembered until their bytes are read
+#  ifndef MMWAVE_RX_MARKS
+#    define MMWAVE_RX_MARKS 32
+#  endif
+
+/**
+ * @brief Transport over an Arduino HardwareSerial port.
+ *
+ * Every UART receive event (RX FIFO full or line idle) is timestamped in
+ * the HardwareSerial event task, with the position in the stream the bytes
+ * received so far reach. read() stops at those positions, so each piece it
+ * returns carries the time its bytes actually arrived, however long they
+ * waited in the driver buffer before fetch() ran. The position is taken
+ * from available() while the application may be reading, so a piece can
+ * be off by one event; with more than MMWAVE_RX_MARKS events unread the
+ * oldest are forgotten and their bytes get the next event's time.
+ */
+class SeeedmmWaveSerialTransport final : public SeeedmmWaveTransport {
+ public:
+  SeeedmmWaveSerialTransport() {}
+
+  void attach(HardwareSerial* serial) {
+    _serial = serial;
+  }
+  HardwareSerial* serial() const {
+    return _serial;
+  }
+
+  void begin(uint32_t baud) override {
+    _serial->setRxBufferSize(1024 * 32);
+    _serial->begin(baud);
+    _serial->setTimeout(1000);
+    _read_total.store(0, std::memory_order_relaxed);
+    _mark_first = 0;
+    _mark_count = 0;
+    // Runs in the HardwareSerial event task whenever the RX FIFO fills up or
+    // goes idle
+    _serial->onReceive([this]() { markReceived(); }, false);
+  }
+  void end() override {
+    _serial->onReceive(nullptr);
+    _serial->end();
+  }
+
+  size_t available() override {
+    return _serial->available();
+  }
+  size_t read(uint8_t* data, size_t len) override {
+    uint32_t total  = _read_total.load(std::memory_order_relaxed);
+    int64_t time_us = -1;
+    portENTER_CRITICAL(&_mark_lock);
+    // Events whose bytes have all been read
+    while (_mark_count && (int32_t)(_marks[_mark_first].end - total) <= 0) {
+      _mark_first = (_mark_first + 1) % MMWAVE_RX_MARKS;
+      _mark_count--;
+    }
+    if (_mark_count) {
+      uint32_t upto = _marks[_mark_first].end - total;
+      if (len > upto)
+        len = upto;
+      time_us = _marks[_mark_first].time_us;
+    }
+    portEXIT_CRITICAL(&_mark_lock);
+
+    size_t got = _serial->readBytes(data, len);
+    _read_total.fetch_add(got, std::memory_order_relaxed);
+    // Bytes whose event has not been handled yet arrived just now
+    _receive_time_us = time_us >= 0 ? time_us : esp_timer_get_time();
+    return got;
+  }
+  int64_t receiveTime() override {
+    return _receive_time_us;
+  }
+
+  size_t availableForWrite() override {
+    int room = _serial->availableForWrite();
+    return room > 0 ? room : 0;
+  }
+  size_t write(const uint8_t* data, size_t len) override {
+    return _serial->write(data, len);
+  }
+
+  // Called from the HardwareSerial event task after the event is marked
+  bool onReceive(void (*callback)(void* ctx), void* ctx) override {
+    portENTER_CRITICAL(&_mark_lock);
+    _callback     = callback;
+    _callback_ctx = ctx;
+    portEXIT_CRITICAL(&_mark_lock);
+    return true;
+  }
+
+ private:
+  typedef struct RxMark {
+    uint32_t end;  // stream position reached by the bytes of the event
+    int64_t time_us;
+  } RxMark;
+
+  void markReceived() {
+    int64_t now = esp_timer_get_time();
+    uint32_t end =
+        _read_total.load(std::memory_order_relaxed) + _serial->available();
+    portENTER_CRITICAL(&_mark_lock);
+    if (_mark_count == MMWAVE_RX_MARKS) {
+      _mark_first = (_mark_first + 1) % MMWAVE_RX_MARKS;
+      _mark_count--;
+    }
+    _marks[(_mark_first + _mark_count) % MMWAVE_RX_MARKS] = {end, now};
+    _mark_count++;
+    void (*callback)(void*) = _callback;
+    void* ctx               = _callback_ctx;
+    portEXIT_CRITICAL(&_mark_lock);
+    if (callback)
+      callback(ctx);
+  }
+
+  HardwareSerial* _serial = nullptr;
+  std::atomic<uint32_t> _read_total{0};  // bytes read since begin()
+  int64_t _receive_time_us = 0;
+
+  portMUX_TYPE _mark_lock = portMUX_INITIALIZER_UNLOCKED;
+  RxMark _marks[MMWAVE_RX_MARKS];
+  size_t _mark_first = 0;
+  size_t _mark_count = 0;
+
+  void (*_callback)(void* ctx) = nullptr;
+  void* _callback_ctx          = nullptr;
+};
+#endif  // MMWAVE_HOST
+
+#endif  // SEEEDMMWAVE_TRANSPORT_H